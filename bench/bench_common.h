@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Runs fn(iterations) a few times and reports the best time per iteration.
+template <typename Fn>
+double benchmarkNsPerOp(const char *name, size_t iterations, Fn &&fn)
+{
+    double best = 1e300;
+    for (int run = 0; run < 5; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        fn(iterations);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        if (ns < best)
+            best = ns;
+    }
+    std::printf("%-40s %12.1f ns/op\n", name, best);
+    return best;
+}
+
+// Keeps the optimizer from discarding a computed value.
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+#ifdef _MSC_VER
+    // MSVC has no inline asm on x64: publishing the address through a
+    // volatile makes the value observable, and the barrier keeps the
+    // compiler from caching memory across the call.
+    static const void *volatile sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
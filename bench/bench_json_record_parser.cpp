@@ -0,0 +1,70 @@
+// Compares the allocation-free record parser against the json::parse path
+// that receiveDataFromPython() used for every record.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "bench_common.h"
+#include "binary_record.h"
+#include "json_record_parser.h"
+
+using json = nlohmann::json;
+
+static std::vector<std::string> makeRecords(size_t n)
+{
+    std::mt19937 gen(27);
+    std::uniform_real_distribution<double> value(0.0, 2000.0);
+    std::vector<std::string> records;
+    records.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        json j = json::array();
+        j.push_back(static_cast<int>(gen() % 4));
+        j.push_back(static_cast<int>(gen() % 4));
+        for (int k = 2; k < 14; ++k)
+            j.push_back(value(gen) / 7.0);
+        j.push_back(1731234567.0 + i * 0.001234);
+        j.push_back(static_cast<int>(i));
+        for (int k = 0; k < 4; ++k)
+            j.push_back(k == 0 ? 1 : 0);
+        records.push_back(j.dump());
+    }
+    return records;
+}
+
+int main()
+{
+    const std::vector<std::string> records = makeRecords(4096);
+    size_t bytes = 0;
+    for (const auto &r : records)
+        bytes += r.size();
+    std::printf("%zu records, %.1f bytes/record\n", records.size(), double(bytes) / records.size());
+
+    double baseline = benchmarkNsPerOp("json::parse + items() -> vector<float>", 200000, [&](size_t n)
+                                       {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const std::string &r = records[i % records.size()];
+            json j = json::parse(r);
+            std::vector<float> dataPoint;
+            for (const auto &[key, value] : j.items())
+                dataPoint.push_back(value.is_number() ? value.get<float>() : 0.0f);
+            doNotOptimize(dataPoint);
+        } });
+
+    double fast = benchmarkNsPerOp("parseJsonRecord -> double[20]", 200000, [&](size_t n)
+                                   {
+        double fields[RECORD_FIELD_COUNT];
+        for (size_t i = 0; i < n; ++i)
+        {
+            const std::string &r = records[i % records.size()];
+            size_t count;
+            parseJsonRecord(r.data(), r.data() + r.size(), fields, RECORD_FIELD_COUNT, count);
+            doNotOptimize(fields);
+        } });
+
+    std::printf("speedup: %.1fx\n", baseline / fast);
+    return 0;
+}
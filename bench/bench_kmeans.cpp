@@ -0,0 +1,49 @@
+// Native KMeans scoring (NativeModel on an export_model.py file): imputer,
+// scaler and the nearest-center search with its distance, at batch sizes 1,
+// 64 and 4096. `python bench/bench_prediction_script.py kmeans_model.pkl`
+// times the prediction_script.py socket path at the same batch sizes.
+//
+//   python export_model.py kmeans_model.pkl kmeans_model.sgm
+//   bench_kmeans [kmeans_model.sgm]
+//
+// The search computes every center's distance for every record, so the
+// cost does not depend on the feature values and random rows are
+// representative.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "bench_common.h"
+#include "native_model.h"
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "kmeans_model.sgm";
+    NativeModel model;
+    if (!model.load(path))
+        return 1;
+
+    const size_t ROW_COUNT = 1 << 14;
+    std::vector<float> rows(ROW_COUNT * MODEL_FEATURE_COUNT);
+    std::mt19937 gen(21);
+    std::lognormal_distribution<float> value(0.0f, 2.0f);
+    for (float &v : rows)
+        v = value(gen);
+    std::vector<uint32_t> classes(ROW_COUNT);
+    std::vector<double> distances(ROW_COUNT);
+
+    for (size_t batch : {size_t(1), size_t(64), size_t(4096)})
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "NativeModel::predict, batch %zu", batch);
+        // One op is one record.
+        benchmarkNsPerOp(name, ROW_COUNT, [&](size_t iterations)
+                         {
+            for (size_t first = 0; first + batch <= iterations; first += batch)
+                model.predict(&rows[first * MODEL_FEATURE_COUNT], batch, &classes[first], &distances[first]);
+            doNotOptimize(classes);
+            doNotOptimize(distances); });
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+"""Cost of scoring a model through prediction_script.py at batch sizes 1, 64
+and 4096, for comparison with the native benchmarks (bench_random_forest,
+bench_kmeans).
+
+Reports per record:
+  - socket: one JSON request and reply per record over loopback, waiting
+    for each reply before the next request
+  - socket pipelined: up to WINDOW requests in flight, as processData()'s
+    PredictionClient keeps them
+  - socket batched: the same, with RECORDS_PER_REQUEST records per request
+    as PredictionClient batches them by default
+  - predict(): prediction_script.predict() alone, one record per call
+  - sklearn batch: imputer, scaler and model.predict once per batch
+
+usage: python bench/bench_prediction_script.py [random_forest_model.pkl]
+"""
+
+import json
+import logging
+import os
+import socket
+import sys
+import threading
+import time
+
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+import prediction_script  # noqa: E402
+
+FEATURE_KEYS = [
+    "IAT",
+    "TD",
+    "Arrival Time",
+    "PC",
+    "Packet Size",
+    "Acknowledgement Packet Size",
+    "RTT",
+    "Average Queue Size",
+    "System Occupancy",
+    "Arrival Rate",
+    "Service Rate",
+    "Packet Dropped",
+]
+BATCH_SIZES = [1, 64, 4096]
+WINDOW = 32
+RECORDS_PER_REQUEST = 32
+
+
+def report(name, seconds, records):
+    print(f"{name:<40} {seconds / records * 1e9:12.1f} ns/op")
+
+
+def serve(model_path):
+    """Runs prediction_script.py's connection handler on a free port."""
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.bind(("localhost", 0))
+    listener.listen()
+    model = prediction_script.load_model(model_path)
+    stats = prediction_script.ModelStats(os.path.basename(model_path))
+
+    def accept():
+        conn, addr = listener.accept()
+        prediction_script.handle_connection(conn, addr, "bench", model, stats)
+
+    threading.Thread(target=accept, daemon=True).start()
+    return listener.getsockname()[1]
+
+
+def main():
+    model_path = sys.argv[1] if len(sys.argv) > 1 else "random_forest_model.pkl"
+    # Per-prediction log lines would dominate the socket numbers.
+    logging.getLogger().setLevel(logging.WARNING)
+
+    model = prediction_script.load_model(model_path)
+    rng = np.random.default_rng(19)
+    rows = rng.lognormal(0.0, 2.0, size=(max(BATCH_SIZES), len(FEATURE_KEYS))).astype(np.float32)
+
+    port = serve(model_path)
+    client = socket.create_connection(("localhost", port))
+    replies = client.makefile("rb")
+    requests = [
+        json.dumps({key: float(v) for key, v in zip(FEATURE_KEYS, row)})
+        for row in rows
+    ]
+    for batch in BATCH_SIZES:
+        start = time.perf_counter()
+        for request in requests[:batch]:
+            client.sendall((request + "\n").encode())
+            replies.readline()
+        report(f"socket, batch {batch}", time.perf_counter() - start, batch)
+
+    for batch in BATCH_SIZES:
+        start = time.perf_counter()
+        in_flight = 0
+        for index, request in enumerate(requests[:batch]):
+            if in_flight == WINDOW:
+                replies.readline()
+                in_flight -= 1
+            client.sendall(f'{{"id":{index},{request[1:]}\n'.encode())
+            in_flight += 1
+        for _ in range(in_flight):
+            replies.readline()
+        report(f"socket pipelined, batch {batch}", time.perf_counter() - start, batch)
+
+    for batch in BATCH_SIZES:
+        start = time.perf_counter()
+        in_flight = 0
+        for index, first in enumerate(range(0, batch, RECORDS_PER_REQUEST)):
+            if in_flight == WINDOW:
+                replies.readline()
+                in_flight -= 1
+            records = ",".join(requests[first:min(first + RECORDS_PER_REQUEST, batch)])
+            client.sendall(f'{{"id":{index},"records":[{records}]}}\n'.encode())
+            in_flight += 1
+        for _ in range(in_flight):
+            replies.readline()
+        report(f"socket batched, batch {batch}", time.perf_counter() - start, batch)
+    client.close()
+
+    for batch in BATCH_SIZES:
+        start = time.perf_counter()
+        for row in rows[:batch]:
+            prediction_script.predict(model, [float(v) for v in row])
+        report(f"predict(), batch {batch}", time.perf_counter() - start, batch)
+
+    for batch in BATCH_SIZES:
+        data = rows[:batch].astype(np.float64)
+        start = time.perf_counter()
+        parts = model if isinstance(model, dict) else {"model": model}
+        for step in ("imputer", "scaler"):
+            if parts.get(step) is not None:
+                data = parts[step].transform(data)
+        parts["model"].predict(data)
+        report(f"sklearn batch, batch {batch}", time.perf_counter() - start, batch)
+
+
+if __name__ == "__main__":
+    main()
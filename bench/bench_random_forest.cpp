@@ -0,0 +1,56 @@
+// Native random forest scoring (NativeModel on an export_model.py file) at
+// batch sizes 1, 64 and 4096, and the cost of mapping and validating the
+// file, which is what a hot reload pays. bench_prediction_script.py times the
+// prediction_script.py path at the same batch sizes for comparison.
+//
+//   python export_model.py random_forest_model.pkl random_forest_model.sgm
+//   bench_random_forest [random_forest_model.sgm]
+//
+// Every record walks each tree for the tree's full depth, so the cost does
+// not depend on the feature values and random rows are representative.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "bench_common.h"
+#include "native_model.h"
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "random_forest_model.sgm";
+    NativeModel model;
+    if (!model.load(path))
+        return 1;
+
+    const size_t ROW_COUNT = 1 << 14;
+    std::vector<float> rows(ROW_COUNT * MODEL_FEATURE_COUNT);
+    std::mt19937 gen(19);
+    std::lognormal_distribution<float> value(0.0f, 2.0f);
+    for (float &v : rows)
+        v = value(gen);
+    std::vector<uint32_t> classes(ROW_COUNT);
+
+    benchmarkNsPerOp("NativeModel::load", 200, [&](size_t iterations)
+                     {
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            NativeModel reloaded;
+            if (!reloaded.load(path))
+                return;
+            doNotOptimize(reloaded);
+        } });
+
+    for (size_t batch : {size_t(1), size_t(64), size_t(4096)})
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "NativeModel::predict, batch %zu", batch);
+        // One op is one record.
+        benchmarkNsPerOp(name, ROW_COUNT, [&](size_t iterations)
+                         {
+            for (size_t first = 0; first + batch <= iterations; first += batch)
+                model.predict(&rows[first * MODEL_FEATURE_COUNT], batch, &classes[first]);
+            doNotOptimize(classes); });
+    }
+    return 0;
+}
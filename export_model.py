@@ -0,0 +1,332 @@
+import glob
+import os
+import struct
+import sys
+import time
+
+import joblib
+import numpy as np
+from sklearn.cluster import KMeans
+from sklearn.ensemble import IsolationForest, RandomForestClassifier
+from sklearn.ensemble._iforest import _average_path_length
+from sklearn.tree import DecisionTreeClassifier
+
+# Native model file layout shared with include/native_model.h: magic
+# "SGMF", version, model kind, feature names, class labels and a table of
+# sections, then the sections themselves, each an aligned array the C++
+# side maps and uses in place. All little-endian.
+MAGIC = b"SGMF"
+VERSION = 2
+KIND_DECISION_TREE = 1
+KIND_RANDOM_FOREST = 2
+KIND_ISOLATION_FOREST = 3
+KIND_KMEANS = 4
+
+SECTION_IMPUTER = 1
+SECTION_SCALER = 2
+SECTION_NODES = 3
+SECTION_TREES = 4
+SECTION_LEAF_ROWS = 5
+SECTION_LEAF_VALUES = 6
+SECTION_PATH_NORMALIZER = 7
+SECTION_CENTERS = 8
+SECTION_CLUSTER_CLASSES = 9
+SECTION_ALIGNMENT = 16
+
+# prediction_script.py labels isolation forest outliers as DDoS.
+ISOLATION_FOREST_CLASSES = ["none", "ddos"]
+
+# Model input order used by prediction_script.py and the C++ feature schema.
+FEATURES = [
+    "IAT",
+    "TD",
+    "Arrival Time",
+    "PC",
+    "Packet Size",
+    "Acknowledgement Packet Size",
+    "RTT",
+    "Average Queue Size",
+    "System Occupancy",
+    "Arrival Rate",
+    "Service Rate",
+    "Packet Dropped",
+]
+
+TREE_LEAF = 0xFFFFFFFF
+TREE_MISSING_LEFT = 0x80000000
+_NODE = struct.Struct("<f3I")
+_TREE = struct.Struct("<2I")
+_SECTION = struct.Struct("<2I2Q")
+
+
+def float32_threshold(threshold):
+    """Largest float32 not above a float64 threshold: for float32 inputs x,
+    x <= result exactly when x <= threshold, as sklearn compares them."""
+    rounded = np.float32(threshold)
+    if float(rounded) > threshold:
+        rounded = np.nextafter(rounded, np.float32(-np.inf))
+    return float(rounded)
+
+
+def flatten_tree(tree, leaf_value, features=None):
+    """Nodes of a fitted sklearn tree, renumbered breadth-first. Each leaf
+    holds leaf_value(node). features maps the tree's feature indices to
+    model inputs when it was fitted on a subset of them."""
+    missing_left = getattr(tree, "missing_go_to_left", None)
+    order = [0]
+    position = {0: 0}
+    for node in order:
+        if tree.children_left[node] != -1:
+            for child in (tree.children_left[node], tree.children_right[node]):
+                position[child] = len(order)
+                order.append(child)
+
+    nodes = []
+    for node in order:
+        if tree.children_left[node] == -1:
+            nodes.append((0.0, TREE_LEAF, leaf_value(node), 0))
+            continue
+        feature = int(tree.feature[node])
+        if features is not None:
+            feature = int(features[feature])
+        if missing_left is not None and missing_left[node]:
+            feature |= TREE_MISSING_LEFT
+        nodes.append(
+            (
+                float32_threshold(float(tree.threshold[node])),
+                feature,
+                position[tree.children_left[node]],
+                position[tree.children_right[node]],
+            )
+        )
+    return nodes
+
+
+def majority_class(tree):
+    return lambda node: int(np.argmax(tree.value[node][0]))
+
+
+def leaf_probabilities(tree, node):
+    """Class probabilities of a leaf, normalized as DecisionTreeClassifier's
+    predict_proba does."""
+    value = np.asarray(tree.value[node][0], dtype=np.float64)
+    total = value.sum()
+    return value / (total if total != 0.0 else 1.0)
+
+
+def check_features(model):
+    names = getattr(model, "feature_names_in_", None)
+    if names is not None and list(names) != FEATURES:
+        raise ValueError(f"model features {list(names)} do not match {FEATURES}")
+    if model.n_features_in_ != len(FEATURES):
+        raise ValueError(f"model expects {model.n_features_in_} features, not {len(FEATURES)}")
+
+
+def encode_text(text):
+    data = text.encode("utf-8")
+    return struct.pack("<I", len(data)) + data
+
+
+def pack_forest(trees):
+    """Lays flattened trees back to back as TreeEnsemble walks them: child
+    indices count from the first tree, and each leaf becomes a node every
+    value stays at (everything is <= inf and NaN goes left), its value row
+    moved to leaf_rows. Returns the nodes, leaf_rows and (root, depth) per
+    tree."""
+    nodes, leaf_rows, roots = [], [], []
+    for tree in trees:
+        root = len(nodes)
+        depth = [0] * len(tree)
+        for index, (threshold, feature, left, right) in enumerate(tree):
+            at = root + index
+            if feature == TREE_LEAF:
+                nodes.append((float("inf"), TREE_MISSING_LEFT, at, at + 1))
+                leaf_rows.append(left)
+                continue
+            depth[left] = depth[right] = depth[index] + 1
+            nodes.append((threshold, feature, root + left, root + right))
+            leaf_rows.append(0)
+        roots.append((root, max(depth)))
+    return nodes, leaf_rows, roots
+
+
+def encode_nodes(nodes):
+    return b"".join(_NODE.pack(*node) for node in nodes)
+
+
+def encode_doubles(values):
+    return np.asarray(values, dtype="<f8").tobytes()
+
+
+def encode_uints(values):
+    return np.asarray(values, dtype="<u4").tobytes()
+
+
+def encode_model(kind, classes, sections):
+    """Header, section table, then the (id, bytes) sections, each starting
+    at a multiple of SECTION_ALIGNMENT."""
+    header = bytearray(MAGIC)
+    header += struct.pack("<3I", VERSION, kind, len(FEATURES))
+    for name in FEATURES:
+        header += encode_text(name)
+    header += struct.pack("<I", len(classes))
+    for label in classes:
+        header += encode_text(str(label))
+    header += struct.pack("<I", len(sections))
+    start = len(header) + len(sections) * _SECTION.size
+    start += -start % SECTION_ALIGNMENT
+    table = bytearray()
+    body = bytearray()
+    for section_id, data in sections:
+        table += _SECTION.pack(section_id, 0, start + len(body), len(data))
+        body += data
+        body += bytes(-len(body) % SECTION_ALIGNMENT)
+    return bytes(header + table + bytes(start - len(header) - len(table)) + body)
+
+
+def forest_sections(trees, rows):
+    nodes, leaf_rows, roots = pack_forest(trees)
+    return [
+        (SECTION_NODES, encode_nodes(nodes)),
+        (SECTION_TREES, b"".join(_TREE.pack(*root) for root in roots)),
+        (SECTION_LEAF_ROWS, encode_uints(leaf_rows)),
+        (SECTION_LEAF_VALUES, encode_doubles(rows)),
+    ]
+
+
+def scaler_sections(scaler):
+    if scaler is None:
+        return []
+    count = len(FEATURES)
+    mean = scaler.mean_ if scaler.mean_ is not None else np.zeros(count)
+    scale = scaler.scale_ if scaler.scale_ is not None else np.ones(count)
+    return [(SECTION_SCALER, encode_doubles(np.concatenate([mean, scale])))]
+
+
+def imputer_sections(imputer):
+    if imputer is None:
+        return []
+    check_features(imputer)
+    statistics = np.asarray(imputer.statistics_, dtype=np.float64)
+    # Anything else changes the columns or which values count as missing.
+    if imputer.add_indicator or not (isinstance(imputer.missing_values, float) and np.isnan(imputer.missing_values)):
+        raise ValueError("only SimpleImputer with missing_values=nan and no indicator is supported")
+    if np.isnan(statistics).any():
+        raise ValueError("imputer drops features that were empty in training")
+    return [(SECTION_IMPUTER, encode_doubles(statistics))]
+
+
+def export_decision_tree(model):
+    check_features(model)
+    nodes = flatten_tree(model.tree_, majority_class(model.tree_))
+    return encode_model(KIND_DECISION_TREE, model.classes_, [(SECTION_NODES, encode_nodes(nodes))])
+
+
+def export_random_forest(model, scaler):
+    check_features(model)
+    rows = []
+
+    def add_row(tree):
+        def leaf_value(node):
+            rows.append(leaf_probabilities(tree, node))
+            return len(rows) - 1
+
+        return leaf_value
+
+    trees = [flatten_tree(estimator.tree_, add_row(estimator.tree_)) for estimator in model.estimators_]
+    sections = scaler_sections(scaler) + forest_sections(trees, rows)
+    return encode_model(KIND_RANDOM_FOREST, model.classes_, sections)
+
+
+def export_isolation_forest(model, scaler, imputer):
+    """Trees with, per leaf, the depth plus average path length term that
+    IsolationForest.score_samples adds up for a record reaching it."""
+    check_features(model)
+    trees = []
+    rows = []
+    for index, (estimator, features) in enumerate(zip(model.estimators_, model.estimators_features_)):
+        tree = estimator.tree_
+        depths = getattr(model, "_decision_path_lengths", None)
+        depths = depths[index] if depths is not None else tree.compute_node_depths()
+        average = _average_path_length(tree.n_node_samples)
+        path_lengths = depths + average - 1.0
+        first = len(rows)
+        rows.extend(float(length) for length in path_lengths)
+        trees.append(flatten_tree(tree, lambda node, first=first: first + int(node), features))
+    sections = imputer_sections(imputer) + scaler_sections(scaler) + forest_sections(trees, rows)
+    normalizer = float(_average_path_length([model._max_samples])[0])
+    sections.append((SECTION_PATH_NORMALIZER, encode_doubles([normalizer])))
+    return encode_model(KIND_ISOLATION_FOREST, ISOLATION_FOREST_CLASSES, sections)
+
+
+def cluster_label(cluster_mappings, cluster):
+    """Attack label prediction_script.py reports for a cluster."""
+    label = str(cluster_mappings.get(cluster, "none")).lower()
+    return "none" if label == "normal" else label
+
+
+def export_kmeans(model, scaler, imputer, cluster_mappings):
+    check_features(model)
+    labels = [cluster_label(cluster_mappings, k) for k in range(len(model.cluster_centers_))]
+    classes = list(dict.fromkeys(labels))
+    sections = imputer_sections(imputer) + scaler_sections(scaler)
+    sections.append((SECTION_CENTERS, encode_doubles(np.ravel(model.cluster_centers_))))
+    sections.append((SECTION_CLUSTER_CLASSES, encode_uints([classes.index(label) for label in labels])))
+    return encode_model(KIND_KMEANS, classes, sections)
+
+
+def replace_file(source, target):
+    """os.replace, except that Windows refuses to replace a file the app
+    still has mapped. Such a file can be renamed, so it is moved aside and
+    deleted by a later export once nothing maps it."""
+    try:
+        os.replace(source, target)
+    except PermissionError:
+        os.replace(target, f"{target}.{os.getpid()}.{time.time_ns()}.old")
+        os.replace(source, target)
+    for stale in glob.glob(glob.escape(target) + ".*.old"):
+        try:
+            os.remove(stale)
+        except OSError:
+            pass  # still mapped
+
+
+def export_model(model_path, output_path):
+    model = joblib.load(model_path)
+    scaler = imputer = None
+    cluster_mappings = {}
+    if isinstance(model, dict):
+        scaler = model.get("scaler")
+        imputer = model.get("imputer")
+        cluster_mappings = model.get("cluster_mappings", {})
+        model = model["model"]
+    if imputer is not None and not isinstance(model, (IsolationForest, KMeans)):
+        raise ValueError(f"{type(model).__name__} with an imputer cannot be exported")
+    if isinstance(model, DecisionTreeClassifier) and scaler is None:
+        data = export_decision_tree(model)
+    elif isinstance(model, RandomForestClassifier):
+        data = export_random_forest(model, scaler)
+    elif isinstance(model, IsolationForest):
+        data = export_isolation_forest(model, scaler, imputer)
+    elif isinstance(model, KMeans):
+        data = export_kmeans(model, scaler, imputer, cluster_mappings)
+    else:
+        raise ValueError(f"{type(model).__name__} cannot be exported")
+    # Write beside the target and rename over it, so a running app that
+    # watches the file never maps a half-written model.
+    temporary_path = f"{output_path}.tmp"
+    with open(temporary_path, "wb") as f:
+        f.write(data)
+    replace_file(temporary_path, output_path)
+    print(f"Exported {type(model).__name__} from {model_path} to {output_path} ({len(data)} bytes)")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("Usage: python export_model.py <model.pkl> <output.sgm>")
+        sys.exit(2)
+    try:
+        export_model(sys.argv[1], sys.argv[2])
+    except Exception as e:
+        print(f"Export failed: {e}", file=sys.stderr)
+        sys.exit(1)
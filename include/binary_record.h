@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "record.h"
+
+// Binary wire format for one data point, as emitted by send_to_cpp() when
+// SG_WIRE_FORMAT=binary (see wire_format.py).
+//
+//   offset 0  uint8   magic 0xA5
+//   offset 1  uint8   magic 'S'
+//   offset 2  uint8   version (1)
+//   offset 3  uint8   field encoding: 0 = float32, 1 = float64
+//   offset 4  uint32  payload length in bytes, little-endian
+//   offset 8  payload: 20 little-endian fields in send_to_cpp() column order.
+//             With float32 encoding the wall-clock timestamp at index 14 is
+//             still sent as a float64, so the payload is 19 * 4 + 8 bytes.
+//
+// A JSON feed never starts with 0xA5, so the first byte of a connection is
+// enough to tell the two formats apart.
+
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define SG_LITTLE_ENDIAN 1
+#endif
+
+constexpr uint8_t BINARY_RECORD_MAGIC0 = 0xA5;
+constexpr uint8_t BINARY_RECORD_MAGIC1 = 'S';
+constexpr uint8_t BINARY_RECORD_VERSION = 1;
+constexpr size_t BINARY_RECORD_HEADER_SIZE = 8;
+
+enum class FieldEncoding : uint8_t
+{
+    FLOAT32 = 0,
+    FLOAT64 = 1
+};
+
+constexpr size_t binaryPayloadSize(FieldEncoding encoding)
+{
+    return encoding == FieldEncoding::FLOAT64 ? RECORD_FIELD_COUNT * 8 : RECORD_PAYLOAD_SIZE;
+}
+
+constexpr size_t MAX_BINARY_RECORD_SIZE = BINARY_RECORD_HEADER_SIZE + binaryPayloadSize(FieldEncoding::FLOAT64);
+
+inline uint32_t loadLE32(const unsigned char *p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t loadLE64(const unsigned char *p)
+{
+    return static_cast<uint64_t>(loadLE32(p)) | (static_cast<uint64_t>(loadLE32(p + 4)) << 32);
+}
+
+inline void storeLE32(unsigned char *p, uint32_t v)
+{
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p[2] = static_cast<unsigned char>(v >> 16);
+    p[3] = static_cast<unsigned char>(v >> 24);
+}
+
+inline void storeLE64(unsigned char *p, uint64_t v)
+{
+    storeLE32(p, static_cast<uint32_t>(v));
+    storeLE32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+// Read-only view over one validated frame. Fields are decoded on access
+// straight from the receive buffer; nothing is copied up front.
+class BinaryRecordView
+{
+public:
+    BinaryRecordView() = default;
+    BinaryRecordView(const unsigned char *payload, FieldEncoding encoding)
+        : payload(payload), encoding(encoding) {}
+
+    double field(size_t index) const
+    {
+        if (encoding == FieldEncoding::FLOAT64)
+        {
+            return loadDouble(payload + index * 8);
+        }
+        if (index == RECORD_TIMESTAMP_FIELD)
+        {
+            return loadDouble(payload + recordFieldOffset(index));
+        }
+        uint32_t bits = loadLE32(payload + recordFieldOffset(index));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // A float32 payload has Record's layout, so on little-endian hosts it is
+    // copied in one go.
+    void decode(Record &record) const
+    {
+#ifdef SG_LITTLE_ENDIAN
+        if (encoding == FieldEncoding::FLOAT32)
+        {
+            std::memcpy(&record, payload, RECORD_PAYLOAD_SIZE);
+            return;
+        }
+#endif
+        for (size_t i = 0; i < RECORD_FIELD_COUNT; ++i)
+        {
+            record.setField(i, field(i));
+        }
+    }
+
+private:
+    static double loadDouble(const unsigned char *p)
+    {
+        uint64_t bits = loadLE64(p);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    const unsigned char *payload = nullptr;
+    FieldEncoding encoding = FieldEncoding::FLOAT32;
+};
+
+enum class FrameStatus
+{
+    COMPLETE,
+    INCOMPLETE,
+    INVALID
+};
+
+// Validates the frame at the start of data. On COMPLETE, view points into
+// data and frameSize is the number of bytes the frame occupies.
+inline FrameStatus parseBinaryFrame(const char *data, size_t len, BinaryRecordView &view, size_t &frameSize)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    if (len >= 1 && bytes[0] != BINARY_RECORD_MAGIC0)
+        return FrameStatus::INVALID;
+    if (len < BINARY_RECORD_HEADER_SIZE)
+        return FrameStatus::INCOMPLETE;
+    if (bytes[1] != BINARY_RECORD_MAGIC1 || bytes[2] != BINARY_RECORD_VERSION || bytes[3] > 1)
+        return FrameStatus::INVALID;
+
+    FieldEncoding encoding = static_cast<FieldEncoding>(bytes[3]);
+    uint32_t payloadLength = loadLE32(bytes + 4);
+    if (payloadLength != binaryPayloadSize(encoding))
+        return FrameStatus::INVALID;
+
+    frameSize = BINARY_RECORD_HEADER_SIZE + payloadLength;
+    if (len < frameSize)
+        return FrameStatus::INCOMPLETE;
+
+    view = BinaryRecordView(bytes + BINARY_RECORD_HEADER_SIZE, encoding);
+    return FrameStatus::COMPLETE;
+}
+
+// Encodes one record into out (at least MAX_BINARY_RECORD_SIZE bytes) and
+// returns the frame size.
+inline size_t encodeBinaryRecord(const double *values, FieldEncoding encoding, char *out)
+{
+    unsigned char *bytes = reinterpret_cast<unsigned char *>(out);
+    size_t payloadLength = binaryPayloadSize(encoding);
+    bytes[0] = BINARY_RECORD_MAGIC0;
+    bytes[1] = BINARY_RECORD_MAGIC1;
+    bytes[2] = BINARY_RECORD_VERSION;
+    bytes[3] = static_cast<uint8_t>(encoding);
+    storeLE32(bytes + 4, static_cast<uint32_t>(payloadLength));
+
+    unsigned char *p = bytes + BINARY_RECORD_HEADER_SIZE;
+    for (size_t i = 0; i < RECORD_FIELD_COUNT; ++i)
+    {
+        if (encoding == FieldEncoding::FLOAT64 || i == RECORD_TIMESTAMP_FIELD)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &values[i], sizeof(bits));
+            storeLE64(p, bits);
+            p += 8;
+        }
+        else
+        {
+            float value = static_cast<float>(values[i]);
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            storeLE32(p, bits);
+            p += 4;
+        }
+    }
+    return BINARY_RECORD_HEADER_SIZE + payloadLength;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Interns (FB, TB) bus pairs into dense, stable ids 0, 1, 2, ... in order of
+// first appearance.
+//
+// Open-addressing table with linear probing over a flat slot array. The
+// pair is packed into one 64-bit key and run through a full-avalanche
+// mixer, so (a, b), (b, a) and (a, a) land in unrelated slots. Slots hold
+// the key next to its id, so a lookup that hits touches one cache line in
+// the common case. The table doubles at 50% load; ids never change once
+// assigned.
+class ConnectionIndex
+{
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    explicit ConnectionIndex(size_t expectedConnections = 64)
+    {
+        reserve(expectedConnections);
+    }
+
+    static uint64_t packKey(int fb, int tb)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(fb)) << 32) | static_cast<uint32_t>(tb);
+    }
+
+    // Returns the id of (fb, tb), assigning the next one on first sight.
+    uint32_t intern(int fb, int tb)
+    {
+        uint64_t key = packKey(fb, tb);
+        size_t slot = probe(key);
+        if (slots[slot].id != NOT_FOUND)
+            return slots[slot].id;
+
+        uint32_t id = static_cast<uint32_t>(keys.size());
+        keys.push_back(key);
+        slots[slot] = {key, id};
+        if (keys.size() * 2 > slots.size())
+            rehash(slots.size() * 2);
+        return id;
+    }
+
+    // Returns the id of (fb, tb), or NOT_FOUND.
+    uint32_t find(int fb, int tb) const
+    {
+        return slots[probe(packKey(fb, tb))].id;
+    }
+
+    std::pair<int, int> connection(uint32_t id) const
+    {
+        uint64_t key = keys[id];
+        return {static_cast<int>(static_cast<uint32_t>(key >> 32)), static_cast<int>(static_cast<uint32_t>(key))};
+    }
+
+    size_t size() const { return keys.size(); }
+
+    void reserve(size_t connections)
+    {
+        size_t capacity = 16;
+        while (capacity < connections * 2)
+            capacity <<= 1;
+        if (capacity > slots.size())
+            rehash(capacity);
+        keys.reserve(connections);
+    }
+
+    void clear()
+    {
+        for (Slot &slot : slots)
+            slot = Slot{};
+        keys.clear();
+    }
+
+private:
+    struct Slot
+    {
+        uint64_t key = 0;
+        uint32_t id = NOT_FOUND;
+    };
+
+    // murmur3 / splitmix64 finalizer.
+    static uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // Slot holding key, or the empty slot where it would go.
+    size_t probe(uint64_t key) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t slot = static_cast<size_t>(mix(key)) & mask;
+        while (slots[slot].id != NOT_FOUND && slots[slot].key != key)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void rehash(size_t capacity)
+    {
+        slots.assign(capacity, Slot{});
+        for (uint32_t id = 0; id < keys.size(); ++id)
+            slots[probe(keys[id])] = {keys[id], id};
+    }
+
+    std::vector<Slot> slots;
+    std::vector<uint64_t> keys; // by id
+};
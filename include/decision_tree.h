@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One node of a flattened decision tree. Sixteen bytes, so four nodes share
+// a cache line; export_model.py writes them breadth-first, which keeps the
+// levels every record walks through packed together at the front.
+struct alignas(16) TreeNode
+{
+    float threshold;  // go left when feature <= threshold
+    uint32_t feature; // feature index, optionally | TREE_MISSING_LEFT; TREE_LEAF for leaves
+    uint32_t left;    // child node index; for a leaf, the leaf value
+    uint32_t right;
+};
+
+static_assert(sizeof(TreeNode) == 16, "TreeNode must stay 16 bytes");
+
+constexpr uint32_t TREE_LEAF = 0xFFFFFFFFu;
+constexpr uint32_t TREE_MISSING_LEFT = 0x80000000u; // NaN features take the left branch
+constexpr uint32_t TREE_FEATURE_MASK = 0x7FFFFFFFu;
+
+// Checks that every node of a tree points at children after it (so every
+// walk ends at a leaf), reads a feature below featureCount, and, for a leaf,
+// holds a value below valueCount.
+inline bool validTree(const TreeNode *nodes, size_t count, uint32_t featureCount, uint32_t valueCount)
+{
+    if (count == 0)
+        return false;
+    for (size_t n = 0; n < count; ++n)
+    {
+        const TreeNode &node = nodes[n];
+        if (node.feature == TREE_LEAF)
+        {
+            if (node.left >= valueCount)
+                return false;
+            continue;
+        }
+        if ((node.feature & TREE_FEATURE_MASK) >= featureCount || node.left <= n || node.right <= n ||
+            node.left >= count || node.right >= count)
+            return false;
+    }
+    return true;
+}
+
+// A single tree stored as a flat node array with the root at index 0. The
+// nodes belong to the caller (the mapped model file) and must outlive it.
+//
+// Thresholds are float: sklearn compares float32 features against float64
+// thresholds, and the exporter rounds every threshold down to the largest
+// float not above it, which keeps the comparison exact.
+class DecisionTree
+{
+public:
+    // Points at the nodes of one tree; false if validTree() rejects them.
+    bool assign(const TreeNode *treeNodes, size_t count, uint32_t featureCount, uint32_t valueCount)
+    {
+        if (!validTree(treeNodes, count, featureCount, valueCount))
+            return false;
+        nodes = treeNodes;
+        nodeTotal = count;
+        return true;
+    }
+
+    // Leaf value reached by one feature vector.
+    uint32_t leafValue(const float *features) const
+    {
+        const TreeNode *node = nodes;
+        while (node->feature != TREE_LEAF)
+        {
+            float value = features[node->feature & TREE_FEATURE_MASK];
+            bool left = value <= node->threshold || (value != value && (node->feature & TREE_MISSING_LEFT));
+            node = &nodes[left ? node->left : node->right];
+        }
+        return node->left;
+    }
+
+    size_t nodeCount() const { return nodeTotal; }
+
+private:
+    const TreeNode *nodes = nullptr;
+    size_t nodeTotal = 0;
+};
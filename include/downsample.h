@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "series_store.h"
+
+enum class DownsampleMode
+{
+    M4,   // first, min, max and last sample of each bucket
+    LTTB, // largest-triangle-three-buckets: one shape-preserving sample per bucket
+};
+
+// Reduces a visible range of one SeriesColumn to about `targetPoints` points
+// for drawing, caching the result per zoom level.
+//
+// Buckets are aligned to absolute sample numbers (SeriesColumn::origin), and
+// the bucket width is rounded up to a power of two, so a bucket keeps its
+// samples while the view scrolls, the ring wraps or new rows arrive. Buckets
+// whose samples can no longer change are computed once; each call only
+// revisits the few at the growing end. Frame cost is therefore bounded by
+// the target point count rather than by history length. Each zoom level
+// keeps its own cache, so switching between a close-up and the whole
+// capture does not start from scratch.
+class Downsampler
+{
+public:
+    // Fills xs()/ys() for logical samples [first, last) of column. X values
+    // are sample timestamps minus timeOrigin. A range that already fits in
+    // targetPoints is copied as is.
+    void update(const SeriesColumn &column, size_t first, size_t last, size_t targetPoints, DownsampleMode mode,
+                double timeOrigin)
+    {
+        xValues.clear();
+        yValues.clear();
+        last = std::min(last, column.size());
+        if (first >= last)
+            return;
+        if (last - first <= targetPoints)
+        {
+            for (size_t i = first; i < last; ++i)
+            {
+                xValues.push_back(column.time(i) - timeOrigin);
+                yValues.push_back(column[i]);
+            }
+            return;
+        }
+
+        size_t pointsPerBucket = mode == DownsampleMode::M4 ? 4 : 1;
+        uint64_t bucketCount = std::max<size_t>(targetPoints / pointsPerBucket, 1);
+        uint64_t width = 1;
+        while (width * bucketCount < last - first)
+            width <<= 1;
+
+        uint64_t origin = column.origin;
+        uint64_t end = origin + column.size();
+        if (end < seenEnd)
+            levels.clear(); // the store was cleared and refilled
+        seenEnd = end;
+
+        // One extra bucket on each side carries the line to the plot edges
+        // and gives LTTB its neighbours.
+        uint64_t firstBucket = (origin + first) / width;
+        uint64_t lastBucket = (origin + last + width - 1) / width;
+        firstBucket = std::max(firstBucket > 0 ? firstBucket - 1 : 0, origin / width);
+        lastBucket = std::min(lastBucket + 1, (end + width - 1) / width);
+
+        Level &level = levels[LevelKey{width, mode}];
+        level.window(firstBucket, lastBucket);
+        for (size_t b = 0; b < level.buckets.size(); ++b)
+        {
+            // The oldest bucket loses samples as the ring wraps.
+            uint64_t bucketFirst = (level.first + b) * width;
+            if (!level.buckets[b].complete || bucketFirst < origin)
+                summarize(column, level.buckets[b], bucketFirst, width, mode);
+        }
+        if (mode == DownsampleMode::LTTB)
+            selectTriangles(column, level, width);
+
+        for (const Bucket &bucket : level.buckets)
+        {
+            for (size_t p = 0; p < bucket.pointCount; ++p)
+            {
+                xValues.push_back(bucket.points[p].time - timeOrigin);
+                yValues.push_back(bucket.points[p].value);
+            }
+        }
+    }
+
+    const std::vector<double> &xs() const { return xValues; }
+    const std::vector<double> &ys() const { return yValues; }
+    int pointCount() const { return static_cast<int>(xValues.size()); }
+
+    void clear()
+    {
+        levels.clear();
+        seenEnd = 0;
+    }
+
+private:
+    struct Point
+    {
+        uint64_t index; // absolute sample number
+        double time;
+        float value;
+    };
+
+    struct Bucket
+    {
+        bool complete = false; // every sample present; the summary is final
+        bool settled = false;  // LTTB: the selected point is final too
+        uint8_t pointCount = 0;
+        Point points[4];
+        double meanX = 0.0; // LTTB: centroid of the bucket's numbers, x in seconds
+        double meanY = 0.0;
+        uint64_t numbers = 0;
+    };
+
+    struct LevelKey
+    {
+        uint64_t width;
+        DownsampleMode mode;
+
+        bool operator<(const LevelKey &other) const
+        {
+            return width != other.width ? width < other.width : mode < other.mode;
+        }
+    };
+
+    // Cached buckets [first, first + buckets.size()) of one zoom level.
+    struct Level
+    {
+        uint64_t first = 0;
+        std::vector<Bucket> buckets;
+
+        // Moves the cache to buckets [from, to), keeping the overlap.
+        void window(uint64_t from, uint64_t to)
+        {
+            uint64_t oldFirst = first;
+            uint64_t oldLast = first + buckets.size();
+            if (from == oldFirst && to == oldLast)
+                return;
+            std::vector<Bucket> moved(to > from ? to - from : 0);
+            for (uint64_t k = std::max(from, oldFirst); k < std::min(to, oldLast); ++k)
+                moved[k - from] = buckets[k - oldFirst];
+            buckets.swap(moved);
+            first = from;
+        }
+    };
+
+    static bool readBucket(const SeriesColumn &column, uint64_t bucketFirst, uint64_t width,
+                           uint64_t &from, uint64_t &to)
+    {
+        uint64_t end = column.origin + column.size();
+        from = std::max(bucketFirst, column.origin);
+        to = std::min(bucketFirst + width, end);
+        return bucketFirst >= column.origin && bucketFirst + width <= end;
+    }
+
+    static float sample(const SeriesColumn &column, uint64_t index)
+    {
+        return column[static_cast<size_t>(index - column.origin)];
+    }
+
+    static double time(const SeriesColumn &column, uint64_t index)
+    {
+        return column.time(static_cast<size_t>(index - column.origin));
+    }
+
+    static void summarize(const SeriesColumn &column, Bucket &bucket, uint64_t bucketFirst, uint64_t width,
+                          DownsampleMode mode)
+    {
+        uint64_t from, to;
+        bucket.complete = readBucket(column, bucketFirst, width, from, to);
+        bucket.settled = false;
+        bucket.pointCount = 0;
+        bucket.numbers = 0;
+
+        Point firstPoint{}, minPoint{}, maxPoint{}, lastPoint{};
+        double sumX = 0.0, sumY = 0.0;
+        for (uint64_t i = from; i < to; ++i)
+        {
+            float value = sample(column, i);
+            if (std::isnan(value))
+                continue;
+            Point point{i, time(column, i), value};
+            if (bucket.numbers++ == 0)
+                firstPoint = minPoint = maxPoint = point;
+            if (value < minPoint.value)
+                minPoint = point;
+            if (value > maxPoint.value)
+                maxPoint = point;
+            lastPoint = point;
+            sumX += point.time;
+            sumY += value;
+        }
+        if (bucket.numbers == 0)
+            return;
+
+        if (mode == DownsampleMode::LTTB)
+        {
+            bucket.meanX = sumX / static_cast<double>(bucket.numbers);
+            bucket.meanY = sumY / static_cast<double>(bucket.numbers);
+            return;
+        }
+
+        // M4: the four extremes in sample order, without repeats.
+        Point ordered[4] = {firstPoint, minPoint, maxPoint, lastPoint};
+        if (ordered[2].index < ordered[1].index)
+            std::swap(ordered[1], ordered[2]);
+        for (const Point &point : ordered)
+        {
+            if (bucket.pointCount == 0 || bucket.points[bucket.pointCount - 1].index != point.index)
+                bucket.points[bucket.pointCount++] = point;
+        }
+    }
+
+    // Picks, left to right, the sample of each bucket that spans the largest
+    // triangle with the previous bucket's pick and the next bucket's centroid.
+    static void selectTriangles(const SeriesColumn &column, Level &level, uint64_t width)
+    {
+        std::vector<Bucket> &buckets = level.buckets;
+        for (size_t b = 0; b < buckets.size(); ++b)
+        {
+            Bucket &bucket = buckets[b];
+            if (bucket.settled)
+                continue;
+            bucket.pointCount = 0;
+            if (bucket.numbers == 0)
+            {
+                bucket.settled = bucket.complete;
+                continue;
+            }
+
+            const Bucket *previous = b > 0 && buckets[b - 1].pointCount > 0 ? &buckets[b - 1] : nullptr;
+            const Bucket *next = b + 1 < buckets.size() && buckets[b + 1].numbers > 0 ? &buckets[b + 1] : nullptr;
+
+            uint64_t from, to;
+            readBucket(column, (level.first + b) * width, width, from, to);
+            Point best{};
+            double bestArea = -1.0;
+            for (uint64_t i = from; i < to; ++i)
+            {
+                float value = sample(column, i);
+                if (std::isnan(value))
+                    continue;
+                if (!previous || !next)
+                {
+                    // Open ends keep their outermost sample, as in plain LTTB.
+                    if (!previous && bestArea >= 0.0)
+                        break;
+                    best = {i, time(column, i), value};
+                    bestArea = 0.0;
+                    continue;
+                }
+                double x = time(column, i);
+                double ax = previous->points[0].time;
+                double ay = previous->points[0].value;
+                double area = std::abs((ax - next->meanX) * (value - ay) - (ax - x) * (next->meanY - ay));
+                if (area > bestArea)
+                {
+                    bestArea = area;
+                    best = {i, x, value};
+                }
+            }
+            bucket.points[0] = best;
+            bucket.pointCount = 1;
+            // Only the previous pick can still move after this, and only at
+            // the left edge as old rows are dropped; that is not worth a
+            // rescan of every bucket to its right.
+            bucket.settled = bucket.complete && b + 1 < buckets.size() && buckets[b + 1].complete;
+        }
+    }
+
+    std::map<LevelKey, Level> levels;
+    uint64_t seenEnd = 0;
+    std::vector<double> xValues;
+    std::vector<double> yValues;
+};
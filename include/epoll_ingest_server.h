@@ -0,0 +1,259 @@
+#pragma once
+
+#ifdef __linux__
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_set>
+
+// Edge-triggered epoll server for the simulator / capture feeds.
+//
+// The listening socket and every accepted client are non-blocking and
+// registered with EPOLLET, so each readiness notification is drained until
+// EAGAIN. There is no polling timeout: the loop sleeps in epoll_wait until
+// data arrives or stop() writes to the wake-up eventfd.
+class EpollIngestServer
+{
+public:
+    using DataHandler = std::function<void(int fd, const char *data, size_t len)>;
+    using CloseHandler = std::function<void(int fd)>;
+
+    static constexpr int MAX_EVENTS = 256;
+    static constexpr size_t READ_CHUNK = 64 * 1024;
+
+    EpollIngestServer()
+    {
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    ~EpollIngestServer()
+    {
+        closeAll();
+        if (wakeFd >= 0)
+        {
+            ::close(wakeFd);
+        }
+    }
+
+    EpollIngestServer(const EpollIngestServer &) = delete;
+    EpollIngestServer &operator=(const EpollIngestServer &) = delete;
+
+    // Binds to the given port on all interfaces and prepares the epoll set.
+    bool open(uint16_t port)
+    {
+        if (wakeFd < 0)
+        {
+            std::cerr << "eventfd failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+        if (listenFd < 0)
+        {
+            std::cerr << "Error creating socket: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        int opt = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+        sockaddr_in serverAddr{};
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+        serverAddr.sin_port = htons(port);
+
+        if (bind(listenFd, reinterpret_cast<sockaddr *>(&serverAddr), sizeof(serverAddr)) < 0)
+        {
+            std::cerr << "Bind failed with error: " << std::strerror(errno) << std::endl;
+            closeAll();
+            return false;
+        }
+
+        if (listen(listenFd, SOMAXCONN) < 0)
+        {
+            std::cerr << "Listen failed with error: " << std::strerror(errno) << std::endl;
+            closeAll();
+            return false;
+        }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0)
+        {
+            std::cerr << "epoll_create1 failed: " << std::strerror(errno) << std::endl;
+            closeAll();
+            return false;
+        }
+
+        if (!addFd(listenFd, EPOLLIN | EPOLLET) || !addFd(wakeFd, EPOLLIN))
+        {
+            closeAll();
+            return false;
+        }
+        return true;
+    }
+
+    // Runs the event loop on the calling thread until stop() is called.
+    void run(const DataHandler &onData, const CloseHandler &onClose = {})
+    {
+        epoll_event events[MAX_EVENTS];
+        char buffer[READ_CHUNK];
+
+        while (!stopping)
+        {
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd)
+                {
+                    uint64_t value;
+                    while (::read(wakeFd, &value, sizeof(value)) > 0)
+                    {
+                    }
+                }
+                else if (fd == listenFd)
+                {
+                    acceptAll();
+                }
+                else
+                {
+                    drainClient(fd, buffer, onData, onClose);
+                }
+            }
+        }
+        closeAll();
+    }
+
+    // Safe to call from any thread; wakes the loop so run() returns.
+    void stop()
+    {
+        stopping = true;
+        if (wakeFd >= 0)
+        {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    size_t connectionCount() const { return clientCount.load(std::memory_order_relaxed); }
+
+private:
+    bool addFd(int fd, uint32_t events)
+    {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            std::cerr << "epoll_ctl ADD failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void acceptAll()
+    {
+        while (true)
+        {
+            int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientFd < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    std::cerr << "Accept failed with error: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            if (!addFd(clientFd, EPOLLIN | EPOLLRDHUP | EPOLLET))
+            {
+                ::close(clientFd);
+                continue;
+            }
+            clients.insert(clientFd);
+            clientCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Hang-ups and errors are detected by recv() itself, after any bytes
+    // still queued on the socket have been delivered.
+    void drainClient(int fd, char *buffer, const DataHandler &onData, const CloseHandler &onClose)
+    {
+        bool closed = false;
+        while (!closed)
+        {
+            ssize_t received = ::recv(fd, buffer, READ_CHUNK, 0);
+            if (received > 0)
+            {
+                onData(fd, buffer, static_cast<size_t>(received));
+            }
+            else if (received == 0)
+            {
+                closed = true;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            else
+            {
+                closed = (errno != EAGAIN && errno != EWOULDBLOCK);
+                break;
+            }
+        }
+
+        if (closed)
+        {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            ::close(fd);
+            clients.erase(fd);
+            clientCount.fetch_sub(1, std::memory_order_relaxed);
+            if (onClose)
+                onClose(fd);
+        }
+    }
+
+    void closeAll()
+    {
+        for (int fd : clients)
+        {
+            ::close(fd);
+        }
+        clients.clear();
+        clientCount.store(0, std::memory_order_relaxed);
+        if (epollFd >= 0)
+        {
+            ::close(epollFd);
+            epollFd = -1;
+        }
+        if (listenFd >= 0)
+        {
+            ::close(listenFd);
+            listenFd = -1;
+        }
+    }
+
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::unordered_set<int> clients;
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> clientCount{0};
+};
+#endif
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include "record.h"
+
+// Single source of truth for what each Record field means downstream: its
+// JSON key in prediction requests (the CSV / prediction_script.py column
+// name), its metric plot, and whether the models were trained on it.
+// Everything else — the plot labels, the per-record metric extraction and
+// the prediction request encoders — is generated from this table.
+struct FieldSchema
+{
+    size_t index;          // position in send_to_cpp()'s column order
+    const char *name;      // Record member
+    const char *jsonKey;   // key in prediction requests
+    const char *plotLabel; // metric plot title, nullptr when not plotted
+    int plotSlot;          // position among the metric plots, -1 when not plotted
+    bool modelFeature;     // part of the model input vector
+    bool attackLabel;      // ground-truth attack flag
+};
+
+constexpr FieldSchema RECORD_SCHEMA[RECORD_FIELD_COUNT] = {
+    {0, "fb", "FB", nullptr, -1, false, false},
+    {1, "tb", "TB", nullptr, -1, false, false},
+    {2, "iat", "IAT", "IAT", 9, true, false},
+    {3, "td", "TD", "Transmission Delay", 4, true, false},
+    {4, "arrivalTime", "Arrival Time", nullptr, -1, true, false},
+    {5, "pc", "PC", "Packet Count (PC)", 11, true, false},
+    {6, "packetSize", "Packet Size", "Packet Size", 8, true, false},
+    {7, "ackPacketSize", "Acknowledgement Packet Size", "Acknowledgement Size", 10, true, false},
+    {8, "rtt", "RTT", "Round Trip Time (RTT)", 5, true, false},
+    {9, "averageQueueSize", "Average Queue Size", "Average Queue Size", 1, true, false},
+    {10, "systemOccupancy", "System Occupancy", "System Occupancy", 2, true, false},
+    {11, "arrivalRate", "Arrival Rate", "Arrival Rate", 6, true, false},
+    {12, "serviceRate", "Service Rate", "Service Rate", 3, true, false},
+    {13, "packetDropped", "Packet Dropped", "Packets Dropped", 0, true, false},
+    {14, "timestamp", "Time", nullptr, -1, false, false},
+    {15, "sample", "Sample", nullptr, -1, false, false},
+    {16, "attackNone", "attack_none", nullptr, -1, false, true},
+    {17, "attackDdos", "attack_ddos", nullptr, -1, false, true},
+    {18, "attackSynflood", "attack_synflood", nullptr, -1, false, true},
+    {19, "attackMitm", "attack_mitm", nullptr, -1, false, true},
+};
+
+// The attack type plot is derived from the four attack flags rather than
+// copied from a single field.
+constexpr int ATTACK_TYPE_PLOT_SLOT = 7;
+constexpr const char *ATTACK_TYPE_PLOT_LABEL = "Attack Type";
+
+namespace schema_detail
+{
+    template <typename Pred>
+    constexpr size_t countFields(Pred pred)
+    {
+        size_t count = 0;
+        for (const auto &field : RECORD_SCHEMA)
+            count += pred(field) ? 1 : 0;
+        return count;
+    }
+
+    template <size_t N, typename Pred>
+    constexpr std::array<size_t, N> collectFields(Pred pred)
+    {
+        std::array<size_t, N> indices{};
+        size_t count = 0;
+        for (const auto &field : RECORD_SCHEMA)
+            if (pred(field))
+                indices[count++] = field.index;
+        return indices;
+    }
+
+    constexpr bool isModelFeature(const FieldSchema &field) { return field.modelFeature; }
+    constexpr bool isAttackLabel(const FieldSchema &field) { return field.attackLabel; }
+    constexpr bool isPlotted(const FieldSchema &field) { return field.plotSlot >= 0; }
+}
+
+constexpr size_t MODEL_FEATURE_COUNT = schema_detail::countFields(schema_detail::isModelFeature);
+constexpr size_t ATTACK_LABEL_COUNT = schema_detail::countFields(schema_detail::isAttackLabel);
+constexpr size_t PLOT_METRIC_COUNT = schema_detail::countFields(schema_detail::isPlotted) + 1;
+
+// Record field indices of the model inputs, in the order the models expect.
+constexpr std::array<size_t, MODEL_FEATURE_COUNT> MODEL_FEATURE_FIELDS =
+    schema_detail::collectFields<MODEL_FEATURE_COUNT>(schema_detail::isModelFeature);
+constexpr std::array<size_t, ATTACK_LABEL_COUNT> ATTACK_LABEL_FIELDS =
+    schema_detail::collectFields<ATTACK_LABEL_COUNT>(schema_detail::isAttackLabel);
+
+namespace schema_detail
+{
+    constexpr std::array<int, PLOT_METRIC_COUNT> makePlotSources()
+    {
+        std::array<int, PLOT_METRIC_COUNT> sources{};
+        for (auto &source : sources)
+            source = -2;
+        sources[ATTACK_TYPE_PLOT_SLOT] = -1;
+        for (const auto &field : RECORD_SCHEMA)
+            if (field.plotSlot >= 0)
+                sources[field.plotSlot] = static_cast<int>(field.index);
+        return sources;
+    }
+
+    constexpr std::array<const char *, PLOT_METRIC_COUNT> makePlotLabels()
+    {
+        std::array<const char *, PLOT_METRIC_COUNT> labels{};
+        labels[ATTACK_TYPE_PLOT_SLOT] = ATTACK_TYPE_PLOT_LABEL;
+        for (const auto &field : RECORD_SCHEMA)
+            if (field.plotSlot >= 0)
+                labels[field.plotSlot] = field.plotLabel;
+        return labels;
+    }
+}
+
+// Record field feeding each metric plot; -1 marks the derived attack type.
+constexpr std::array<int, PLOT_METRIC_COUNT> PLOT_SOURCE_FIELDS = schema_detail::makePlotSources();
+constexpr std::array<const char *, PLOT_METRIC_COUNT> PLOT_LABELS = schema_detail::makePlotLabels();
+
+namespace schema_detail
+{
+    constexpr bool schemaIsConsistent()
+    {
+        for (size_t i = 0; i < RECORD_FIELD_COUNT; ++i)
+        {
+            const FieldSchema &field = RECORD_SCHEMA[i];
+            if (field.index != i || (field.plotSlot >= 0) != (field.plotLabel != nullptr))
+                return false;
+            if (field.plotSlot == ATTACK_TYPE_PLOT_SLOT || field.plotSlot >= static_cast<int>(PLOT_METRIC_COUNT))
+                return false;
+        }
+        for (int source : PLOT_SOURCE_FIELDS)
+            if (source == -2)
+                return false;
+        return true;
+    }
+}
+
+static_assert(schema_detail::schemaIsConsistent(), "RECORD_SCHEMA has a gap or overlap in its plot slots");
+static_assert(MODEL_FEATURE_COUNT == 12, "prediction_script.py expects 12 model features");
+static_assert(PLOT_METRIC_COUNT == 12, "metric plot count changed");
+
+// 0 = normal, 1 = DDoS, 2 = SYN flood, 3 = MITM, matching ATTACK_COLORS.
+inline float attackTypeCode(const Record &record)
+{
+    if (record.attackDdos > 0.5f)
+        return 1.0f;
+    if (record.attackSynflood > 0.5f)
+        return 2.0f;
+    if (record.attackMitm > 0.5f)
+        return 3.0f;
+    return 0.0f;
+}
+
+// Attack type names by code, lower-case as prediction_script.py reports them.
+constexpr size_t ATTACK_TYPE_COUNT = 4;
+constexpr const char *ATTACK_TYPE_KEYS[ATTACK_TYPE_COUNT] = {"none", "ddos", "synflood", "mitm"};
+
+// Code of a model class label, ignoring case and reading "normal" as
+// "none"; -1 when the label names no known attack type.
+inline int attackTypeFromLabel(const std::string &label)
+{
+    std::string lower;
+    for (char c : label)
+        lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (lower == "normal")
+        return 0;
+    for (size_t code = 0; code < ATTACK_TYPE_COUNT; ++code)
+        if (lower == ATTACK_TYPE_KEYS[code])
+            return static_cast<int>(code);
+    return -1;
+}
+
+namespace schema_detail
+{
+    template <size_t Slot>
+    inline float plotValue(const Record &record)
+    {
+        if constexpr (PLOT_SOURCE_FIELDS[Slot] < 0)
+            return attackTypeCode(record);
+        else
+            return static_cast<float>(record.field(static_cast<size_t>(PLOT_SOURCE_FIELDS[Slot])));
+    }
+
+    template <size_t... Slot>
+    inline void extractPlotValues(const Record &record, float *out, std::index_sequence<Slot...>)
+    {
+        ((out[Slot] = plotValue<Slot>(record)), ...);
+    }
+
+    template <size_t... I, typename Fn>
+    inline void forEachModelFeature(const Record &record, Fn &fn, std::index_sequence<I...>)
+    {
+        (fn(RECORD_SCHEMA[MODEL_FEATURE_FIELDS[I]].jsonKey,
+            static_cast<float>(record.field(MODEL_FEATURE_FIELDS[I]))),
+         ...);
+    }
+
+    template <size_t... I, typename Fn>
+    inline void forEachAttackLabel(const Record &record, Fn &fn, std::index_sequence<I...>)
+    {
+        (fn(RECORD_SCHEMA[ATTACK_LABEL_FIELDS[I]].jsonKey,
+            record.field(ATTACK_LABEL_FIELDS[I]) > 0.5 ? 1 : 0),
+         ...);
+    }
+}
+
+// Writes the value of every metric plot for one record, in plot order.
+inline void extractPlotValues(const Record &record, float (&out)[PLOT_METRIC_COUNT])
+{
+    schema_detail::extractPlotValues(record, out, std::make_index_sequence<PLOT_METRIC_COUNT>{});
+}
+
+// Calls fn(jsonKey, float value) for each model feature, in model order.
+template <typename Fn>
+inline void forEachModelFeature(const Record &record, Fn &&fn)
+{
+    schema_detail::forEachModelFeature(record, fn, std::make_index_sequence<MODEL_FEATURE_COUNT>{});
+}
+
+// Calls fn(jsonKey, int flag) for each ground-truth attack flag.
+template <typename Fn>
+inline void forEachAttackLabel(const Record &record, Fn &&fn)
+{
+    schema_detail::forEachAttackLabel(record, fn, std::make_index_sequence<ATTACK_LABEL_COUNT>{});
+}
+
+// Writes the model input vector for one record.
+inline void extractModelFeatures(const Record &record, float (&out)[MODEL_FEATURE_COUNT])
+{
+    size_t i = 0;
+    forEachModelFeature(record, [&](const char *, float value)
+                        { out[i++] = value; });
+}
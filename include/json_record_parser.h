@@ -0,0 +1,207 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "record.h"
+
+// Allocation-free parser for the flat numeric array that send_to_cpp()
+// emits, e.g. "[1, 2, 0.0123, ..., 1731234567.123456, 0, 1, 0, 0, 0]".
+//
+// Numbers are written straight into the caller's fixed-size buffer. Most
+// values Python prints (at most 15 significant digits and a small exponent)
+// are converted exactly with one integer accumulate and one multiply or
+// divide by a power of ten; anything longer goes through std::from_chars.
+// Python's NaN / Infinity / -Infinity literals are accepted as well.
+//
+// Returns false for anything that is not a flat array of at most capacity
+// numbers (exactly RECORD_FIELD_COUNT for the Record overload), so the
+// caller can fall back to a general JSON parser.
+
+namespace json_record_detail
+{
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    inline bool isDigit(char c)
+    {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    inline const char *skipSpace(const char *p, const char *end)
+    {
+        while (p < end && isSpace(*p))
+            ++p;
+        return p;
+    }
+
+    inline bool matchLiteral(const char *&p, const char *end, const char *literal, size_t len)
+    {
+        if (static_cast<size_t>(end - p) < len || std::memcmp(p, literal, len) != 0)
+            return false;
+        p += len;
+        return true;
+    }
+
+    // Exactly representable powers of ten (Clinger's fast path).
+    constexpr double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    // Long mantissas and large exponents: let the standard library round the
+    // whole token correctly, restarting from its first character.
+    inline bool parseNumberSlow(const char *start, const char *end, const char *&p, double &out)
+    {
+        auto result = std::from_chars(start, end, out);
+        if (result.ec != std::errc() || result.ptr < p)
+            return false;
+        p = result.ptr;
+        return true;
+    }
+
+    inline bool parseNumber(const char *&p, const char *end, double &out)
+    {
+        const char *start = p;
+        bool negative = false;
+        if (p < end && *p == '-')
+        {
+            negative = true;
+            ++p;
+        }
+
+        if (p < end && (*p == 'N' || *p == 'I'))
+        {
+            if (!negative && matchLiteral(p, end, "NaN", 3))
+            {
+                out = std::numeric_limits<double>::quiet_NaN();
+                return true;
+            }
+            if (matchLiteral(p, end, "Infinity", 8))
+            {
+                out = negative ? -std::numeric_limits<double>::infinity()
+                               : std::numeric_limits<double>::infinity();
+                return true;
+            }
+            return false;
+        }
+
+        if (p >= end || !isDigit(*p))
+            return false;
+
+        uint64_t mantissa = 0;
+        int digits = 0; // significant digits, at most 15 on the fast path
+        int exponent = 0;
+
+        if (*p == '0')
+        {
+            ++p;
+        }
+        else
+        {
+            while (p < end && isDigit(*p))
+            {
+                if (++digits > 15)
+                    return parseNumberSlow(start, end, p, out);
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                ++p;
+            }
+        }
+
+        if (p < end && *p == '.')
+        {
+            ++p;
+            if (p >= end || !isDigit(*p))
+                return false;
+            while (p < end && isDigit(*p))
+            {
+                if ((mantissa != 0 || *p != '0') && ++digits > 15)
+                    return parseNumberSlow(start, end, p, out);
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                --exponent;
+                ++p;
+            }
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            ++p;
+            bool negativeExponent = false;
+            if (p < end && (*p == '+' || *p == '-'))
+            {
+                negativeExponent = *p == '-';
+                ++p;
+            }
+            if (p >= end || !isDigit(*p))
+                return false;
+            int explicitExponent = 0;
+            while (p < end && isDigit(*p))
+            {
+                if (explicitExponent < 100000)
+                    explicitExponent = explicitExponent * 10 + (*p - '0');
+                ++p;
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        }
+
+        if (exponent >= -22 && exponent <= 22)
+        {
+            double value = static_cast<double>(mantissa);
+            value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+            out = negative ? -value : value;
+            return true;
+        }
+        return parseNumberSlow(start, end, p, out);
+    }
+}
+
+// Calls store(index, value) for each number; the storage is the caller's.
+template <typename Store>
+inline bool parseJsonNumberArray(const char *begin, const char *end, size_t capacity, size_t &count, Store &&store)
+{
+    using namespace json_record_detail;
+
+    count = 0;
+    const char *p = skipSpace(begin, end);
+    if (p >= end || *p != '[')
+        return false;
+    p = skipSpace(p + 1, end);
+
+    if (p < end && *p == ']')
+        return skipSpace(p + 1, end) == end;
+
+    while (true)
+    {
+        double value;
+        if (count == capacity || !parseNumber(p, end, value))
+            return false;
+        store(count++, value);
+
+        p = skipSpace(p, end);
+        if (p >= end)
+            return false;
+        if (*p == ']')
+            return skipSpace(p + 1, end) == end;
+        if (*p != ',')
+            return false;
+        p = skipSpace(p + 1, end);
+    }
+}
+
+inline bool parseJsonRecord(const char *begin, const char *end, double *out, size_t capacity, size_t &count)
+{
+    return parseJsonNumberArray(begin, end, capacity, count, [out](size_t index, double value)
+                                { out[index] = value; });
+}
+
+// Parses straight into a Record; succeeds only for exactly RECORD_FIELD_COUNT values.
+inline bool parseJsonRecord(const char *begin, const char *end, Record &record)
+{
+    size_t count = 0;
+    bool ok = parseJsonNumberArray(begin, end, RECORD_FIELD_COUNT, count, [&record](size_t index, double value)
+                                   { record.setField(index, value); });
+    return ok && count == RECORD_FIELD_COUNT;
+}
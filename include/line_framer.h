@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Per-connection reassembly buffer for newline-terminated records.
+//
+// Incoming bytes are copied into a power-of-two ring. Every complete line is
+// handed to the caller, in place when it is contiguous in the ring and via a
+// scratch copy when it wraps. A trailing partial line stays in the ring until
+// the rest of it arrives with a later read. A line that outgrows
+// maxLineLength is discarded up to its terminating newline and counted as a
+// framing error, as is any line the caller fails to decode.
+class LineFramer
+{
+public:
+    explicit LineFramer(size_t initialCapacity = 4096, size_t maxLineLength = 64 * 1024)
+        : maxLine(maxLineLength)
+    {
+        size_t capacity = 64;
+        while (capacity < initialCapacity)
+            capacity <<= 1;
+        ring.resize(capacity);
+    }
+
+    // Appends received bytes and calls onLine(const char *begin, size_t len)
+    // for every complete line, in arrival order. onLine returns false when
+    // the line could not be decoded. Returns the number of lines delivered.
+    template <typename OnLine>
+    size_t feed(const char *data, size_t len, OnLine &&onLine)
+    {
+        size_t delivered = 0;
+        while (len > 0)
+        {
+            if (freeSpace() == 0 && !grow())
+            {
+                // A single line filled the largest allowed buffer.
+                if (!discarding)
+                    ++framingErrors_;
+                discarding = true;
+                head = scanPos = tail;
+            }
+
+            size_t chunk = std::min(len, freeSpace());
+            write(data, chunk);
+            data += chunk;
+            len -= chunk;
+            delivered += scan(onLine);
+        }
+        return delivered;
+    }
+
+    size_t pending() const { return tail - head; }
+    size_t capacity() const { return ring.size(); }
+    uint64_t framingErrors() const { return framingErrors_; }
+    uint64_t linesDecoded() const { return linesDecoded_; }
+
+private:
+    size_t mask() const { return ring.size() - 1; }
+    size_t freeSpace() const { return ring.size() - (tail - head); }
+
+    void write(const char *data, size_t len)
+    {
+        size_t offset = tail & mask();
+        size_t first = std::min(len, ring.size() - offset);
+        std::memcpy(ring.data() + offset, data, first);
+        std::memcpy(ring.data(), data + first, len - first);
+        tail += len;
+    }
+
+    bool grow()
+    {
+        if (ring.size() >= maxLine)
+            return false;
+        std::vector<char> larger(ring.size() * 2);
+        size_t used = tail - head;
+        copyOut(head, used, larger.data());
+        scanPos -= head;
+        head = 0;
+        tail = used;
+        ring.swap(larger);
+        return true;
+    }
+
+    void copyOut(size_t from, size_t len, char *dest) const
+    {
+        size_t offset = from & mask();
+        size_t first = std::min(len, ring.size() - offset);
+        std::memcpy(dest, ring.data() + offset, first);
+        std::memcpy(dest + first, ring.data(), len - first);
+    }
+
+    template <typename OnLine>
+    size_t scan(OnLine &onLine)
+    {
+        size_t delivered = 0;
+        while (scanPos < tail)
+        {
+            size_t offset = scanPos & mask();
+            size_t segment = std::min(tail - scanPos, ring.size() - offset);
+            const char *start = ring.data() + offset;
+            const char *newline = static_cast<const char *>(std::memchr(start, '\n', segment));
+            if (!newline)
+            {
+                scanPos += segment;
+                continue;
+            }
+
+            size_t lineEnd = scanPos + static_cast<size_t>(newline - start);
+            size_t lineLen = lineEnd - head;
+            if (discarding)
+            {
+                discarding = false;
+            }
+            else if (lineLen > 0)
+            {
+                size_t lineOffset = head & mask();
+                const char *line;
+                if (lineOffset + lineLen <= ring.size())
+                {
+                    line = ring.data() + lineOffset;
+                }
+                else
+                {
+                    scratch.resize(lineLen);
+                    copyOut(head, lineLen, scratch.data());
+                    line = scratch.data();
+                }
+                if (line[lineLen - 1] == '\r')
+                    --lineLen;
+                if (lineLen > 0)
+                {
+                    if (onLine(line, lineLen))
+                        ++linesDecoded_;
+                    else
+                        ++framingErrors_;
+                    ++delivered;
+                }
+            }
+            head = scanPos = lineEnd + 1;
+        }
+        return delivered;
+    }
+
+    std::vector<char> ring;
+    std::vector<char> scratch;
+    size_t head = 0;    // first byte of the oldest incomplete line
+    size_t tail = 0;    // one past the last byte written
+    size_t scanPos = 0; // bytes before this are known to contain no newline
+    size_t maxLine;
+    bool discarding = false;
+    uint64_t framingErrors_ = 0;
+    uint64_t linesDecoded_ = 0;
+};
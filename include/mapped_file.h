@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only mapping of a whole file. The view stays valid until the object
+// is closed or destroyed, even if the file is replaced by renaming a new
+// version over it, which is how export_model.py writes model files.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept : base(other.base), length(other.length)
+    {
+        other.base = nullptr;
+        other.length = 0;
+    }
+    MappedFile &operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            base = other.base;
+            length = other.length;
+            other.base = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+    ~MappedFile() { close(); }
+
+    // Maps path; logs the reason and returns false on failure.
+    bool open(const std::filesystem::path &path)
+    {
+        close();
+#ifdef _WIN32
+        // FILE_SHARE_DELETE lets a new version be renamed over the file
+        // while it is mapped.
+        HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            std::cerr << "Failed to open " << path.string() << ": " << GetLastError() << std::endl;
+            return false;
+        }
+        LARGE_INTEGER size;
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+            base = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!base)
+            std::cerr << "Failed to map " << path.string() << ": " << GetLastError() << std::endl;
+        // The view keeps the file's contents alive on its own.
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        if (!base)
+            return false;
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            std::cerr << "Failed to open " << path.string() << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        struct stat info;
+        void *view = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0)
+            view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED)
+            std::cerr << "Failed to map " << path.string() << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+        base = static_cast<const unsigned char *>(view);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void close()
+    {
+        if (!base)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        ::munmap(const_cast<unsigned char *>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    const unsigned char *data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char *base = nullptr;
+    size_t length = 0;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Multi-resolution min/max index over a fixed array of samples that it does
+// not own (one column of a SeriesStore block).
+//
+// Samples are grouped into leaves of LEAF consecutive slots; a bottom-up
+// segment tree holds the min and max of every leaf and of every power-of-two
+// run of leaves above them. Overwriting one slot rescans its leaf and walks
+// up the tree, and a min/max query over any slot range costs O(log n) plus a
+// scan of at most two partial leaves. The index adds about n / 4 floats per
+// n samples. NaN samples never become a min or max.
+class MinMaxPyramid
+{
+public:
+    static constexpr size_t LEAF = 16;
+
+    // Sizes the index for `capacity` slots and indexes the first `size`.
+    void rebuild(const float *samples, size_t size, size_t capacity)
+    {
+        size_t leaves = (capacity + LEAF - 1) / LEAF;
+        base = 1;
+        while (base < leaves)
+            base <<= 1;
+        mins.assign(2 * base, EMPTY_MIN);
+        maxs.assign(2 * base, EMPTY_MAX);
+        for (size_t leaf = 0; leaf * LEAF < size; ++leaf)
+            scanLeaf(samples, size, leaf);
+        for (size_t node = base - 1; node > 0; --node)
+            pull(node);
+    }
+
+    // Re-indexes the leaf holding slot `position` after it was written;
+    // `size` is the number of valid slots.
+    void update(const float *samples, size_t size, size_t position)
+    {
+        size_t node = scanLeaf(samples, size, position / LEAF);
+        for (node >>= 1; node > 0; node >>= 1)
+            pull(node);
+    }
+
+    // Min and max over slots [first, last). Leaves min/max untouched apart
+    // from widening them, so several ranges can be folded together.
+    void query(const float *samples, size_t first, size_t last, float &min, float &max) const
+    {
+        if (first >= last)
+            return;
+        size_t firstLeaf = (first + LEAF - 1) / LEAF;
+        size_t lastLeaf = last / LEAF;
+        if (firstLeaf >= lastLeaf)
+        {
+            scan(samples, first, last, min, max);
+            return;
+        }
+        scan(samples, first, firstLeaf * LEAF, min, max);
+        scan(samples, lastLeaf * LEAF, last, min, max);
+        for (size_t lo = firstLeaf + base, hi = lastLeaf + base; lo < hi; lo >>= 1, hi >>= 1)
+        {
+            if (lo & 1)
+                fold(lo++, min, max);
+            if (hi & 1)
+                fold(--hi, min, max);
+        }
+    }
+
+    static constexpr float EMPTY_MIN = std::numeric_limits<float>::infinity();
+    static constexpr float EMPTY_MAX = -std::numeric_limits<float>::infinity();
+
+private:
+    static void scan(const float *samples, size_t first, size_t last, float &min, float &max)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            if (samples[i] < min)
+                min = samples[i];
+            if (samples[i] > max)
+                max = samples[i];
+        }
+    }
+
+    size_t scanLeaf(const float *samples, size_t size, size_t leaf)
+    {
+        size_t node = base + leaf;
+        float min = EMPTY_MIN;
+        float max = EMPTY_MAX;
+        size_t first = leaf * LEAF;
+        scan(samples, first, first + LEAF < size ? first + LEAF : size, min, max);
+        mins[node] = min;
+        maxs[node] = max;
+        return node;
+    }
+
+    void pull(size_t node)
+    {
+        mins[node] = mins[2 * node] < mins[2 * node + 1] ? mins[2 * node] : mins[2 * node + 1];
+        maxs[node] = maxs[2 * node] > maxs[2 * node + 1] ? maxs[2 * node] : maxs[2 * node + 1];
+    }
+
+    void fold(size_t node, float &min, float &max) const
+    {
+        if (mins[node] < min)
+            min = mins[node];
+        if (maxs[node] > max)
+            max = maxs[node];
+    }
+
+    size_t base = 1;         // leaf count rounded up to a power of two
+    std::vector<float> mins; // 2 * base nodes, leaves at [base, 2 * base)
+    std::vector<float> maxs;
+};
@@ -0,0 +1,432 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "binary_record.h"
+#include "decision_tree.h"
+#include "feature_schema.h"
+#include "mapped_file.h"
+#include "nearest_centroid.h"
+#include "preprocessing.h"
+#include "tree_ensemble.h"
+
+// Model file written by export_model.py from a trained .pkl, evaluated in
+// process instead of through prediction_script.py. The file is mapped
+// rather than read: trees, leaf tables and centers are used where they lie,
+// so loading a model costs little more than validating it.
+//
+//   char[4] magic "SGMF"
+//   uint32  format version (2)
+//   uint32  model kind (NativeModelKind)
+//   uint32  feature count, then per feature: uint32 byte length, UTF-8 name;
+//           must be the model features of RECORD_SCHEMA, in order
+//   uint32  class count, then per class: uint32 byte length, UTF-8 label
+//   uint32  section count, then per section: uint32 id (NativeModelSection),
+//           uint32 reserved, uint64 offset from the start of the file,
+//           uint64 size in bytes
+//
+// Sections start at multiples of NATIVE_MODEL_SECTION_ALIGNMENT and hold
+// plain arrays. Which ones a kind needs:
+//
+//   DECISION_TREE    NODES in the DecisionTree layout, a leaf's value being
+//                    its class index
+//   RANDOM_FOREST    NODES, TREES, LEAF_ROWS and LEAF_VALUES in the
+//                    TreeEnsemble layout, a row holding the leaf's class
+//                    probabilities; optional IMPUTER and SCALER
+//   ISOLATION_FOREST as RANDOM_FOREST with one value per row: leaf depth
+//                    counted from 1 plus the average path length of the
+//                    leaf's samples, minus 1; and PATH_NORMALIZER. Its two
+//                    classes are the inlier label and the label of records
+//                    scoring below the threshold
+//   KMEANS           CENTERS and CLUSTER_CLASSES, the attack labels of its
+//                    clusters being its classes; optional IMPUTER and SCALER
+//
+// Unknown section ids are skipped. Everything is little-endian, and the
+// arrays are only mapped on little-endian hosts.
+
+constexpr char NATIVE_MODEL_MAGIC[4] = {'S', 'G', 'M', 'F'};
+constexpr uint32_t NATIVE_MODEL_VERSION = 2;
+constexpr size_t NATIVE_MODEL_SECTION_ALIGNMENT = 16;
+
+enum class NativeModelKind : uint32_t
+{
+    DECISION_TREE = 1,
+    RANDOM_FOREST = 2,
+    ISOLATION_FOREST = 3,
+    KMEANS = 4,
+};
+
+enum class NativeModelSection : uint32_t
+{
+    IMPUTER = 1,         // float64 statistic per feature, filled in for NaN
+    SCALER = 2,          // float64 mean per feature, then float64 scale per feature
+    NODES = 3,           // TreeNode
+    TREES = 4,           // TreeEnsemble::Tree per tree
+    LEAF_ROWS = 5,       // uint32 per node
+    LEAF_VALUES = 6,     // float64 rows of leaf values
+    PATH_NORMALIZER = 7, // float64 average path length of max_samples
+    CENTERS = 8,         // float64 coordinates per feature per cluster
+    CLUSTER_CLASSES = 9, // uint32 class index per cluster
+};
+constexpr uint32_t NATIVE_MODEL_SECTION_LIMIT = 9;
+
+// score_samples() cut-off below which prediction_script.py reports an
+// isolation forest record as an attack.
+constexpr double DEFAULT_ANOMALY_THRESHOLD = -0.5;
+
+class NativeModel
+{
+public:
+    // Maps and validates a model file; logs the reason and returns false
+    // when it cannot be used.
+    bool load(const std::filesystem::path &path)
+    {
+        MappedFile file;
+        if (!file.open(path))
+            return false;
+        std::string error = parse(file.data(), file.size());
+        if (!error.empty())
+        {
+            std::cerr << "Invalid native model " << path.string() << ": " << error << std::endl;
+            return false;
+        }
+        // Moving the mapping keeps its address, so the views stay valid.
+        mapping = std::move(file);
+        return true;
+    }
+
+    // Class index predicted for each of count rows of MODEL_FEATURE_COUNT
+    // features. Models with a score (hasScores()) also write one per row to
+    // scores when it is not null: score_samples() for an isolation forest,
+    // from -1 for the most anomalous to 0, and the distance to the nearest
+    // cluster center for KMeans. An isolation forest predicts its second
+    // class for scores below threshold.
+    void predict(const float *features, size_t count, uint32_t *classes, double *scores = nullptr,
+                 double threshold = DEFAULT_ANOMALY_THRESHOLD) const
+    {
+        if (kind == NativeModelKind::DECISION_TREE)
+        {
+            for (size_t r = 0; r < count; ++r)
+                classes[r] = tree.leafValue(features + r * MODEL_FEATURE_COUNT);
+            return;
+        }
+
+        if (kind == NativeModelKind::KMEANS)
+        {
+            // KMeans keeps the float64 rows the preprocessing produces.
+            std::vector<double> rows(count * MODEL_FEATURE_COUNT), distances;
+            preprocessor.apply(features, rows.data(), count, MODEL_FEATURE_COUNT);
+            if (!scores)
+            {
+                distances.resize(count);
+                scores = distances.data();
+            }
+            centroids.nearest(rows.data(), count, classes, scores);
+            for (size_t r = 0; r < count; ++r)
+                classes[r] = clusterClasses[classes[r]];
+            return;
+        }
+
+        std::vector<double> sums;
+        forestSums(features, count, sums);
+        if (kind == NativeModelKind::ISOLATION_FOREST)
+        {
+            for (size_t r = 0; r < count; ++r)
+            {
+                double score = anomalyScore(sums[r]);
+                classes[r] = score < threshold ? 1 : 0;
+                if (scores)
+                    scores[r] = score;
+            }
+            return;
+        }
+
+        // predict_proba's mean over the trees, first class on ties.
+        size_t classCount = classLabels.size();
+        double treeTotal = static_cast<double>(forest.treeCount());
+        for (size_t r = 0; r < count; ++r)
+        {
+            const double *sum = &sums[r * classCount];
+            uint32_t best = 0;
+            double bestProbability = sum[0] / treeTotal;
+            for (uint32_t c = 1; c < classCount; ++c)
+            {
+                double probability = sum[c] / treeTotal;
+                if (probability > bestProbability)
+                {
+                    best = c;
+                    bestProbability = probability;
+                }
+            }
+            classes[r] = best;
+        }
+    }
+
+    bool hasScores() const { return kind == NativeModelKind::ISOLATION_FOREST || kind == NativeModelKind::KMEANS; }
+    NativeModelKind modelKind() const { return kind; }
+
+    // Attack type code of a class, as attackTypeCode() (0 = none).
+    int attackCode(uint32_t classIndex) const { return classCodes[classIndex]; }
+    const std::string &label(uint32_t classIndex) const { return classLabels[classIndex]; }
+    size_t classCount() const { return classLabels.size(); }
+
+private:
+    class Reader
+    {
+    public:
+        Reader(const unsigned char *data, size_t size) : bytes(data), length(size) {}
+
+        bool u32(uint32_t &value)
+        {
+            if (length - offset < 4)
+                return false;
+            value = loadLE32(bytes + offset);
+            offset += 4;
+            return true;
+        }
+
+        bool u64(uint64_t &value)
+        {
+            if (length - offset < 8)
+                return false;
+            value = loadLE64(bytes + offset);
+            offset += 8;
+            return true;
+        }
+
+        bool text(std::string &value)
+        {
+            uint32_t size;
+            if (!u32(size) || length - offset < size)
+                return false;
+            value.assign(reinterpret_cast<const char *>(bytes + offset), size);
+            offset += size;
+            return true;
+        }
+
+        size_t position() const { return offset; }
+
+    private:
+        const unsigned char *bytes;
+        size_t length;
+        size_t offset = 0;
+    };
+
+    struct Section
+    {
+        const unsigned char *data = nullptr;
+        size_t size = 0;
+    };
+
+    std::string parse(const unsigned char *data, size_t size)
+    {
+        if (size < 4 || std::memcmp(data, NATIVE_MODEL_MAGIC, 4) != 0)
+            return "not a native model file";
+#ifndef SG_LITTLE_ENDIAN
+        return "model files can only be mapped on little-endian hosts";
+#else
+        Reader reader(data, size);
+        uint32_t magic, version = 0, kindValue, featureCount, classCount, sectionCount;
+        reader.u32(magic);
+        if (!reader.u32(version) || version != NATIVE_MODEL_VERSION)
+            return "format version " + std::to_string(version) + ", this build reads " +
+                   std::to_string(NATIVE_MODEL_VERSION);
+        if (!reader.u32(kindValue) || kindValue < static_cast<uint32_t>(NativeModelKind::DECISION_TREE) ||
+            kindValue > static_cast<uint32_t>(NativeModelKind::KMEANS))
+            return "unsupported model kind";
+
+        if (!reader.u32(featureCount) || featureCount != MODEL_FEATURE_COUNT)
+            return "expected " + std::to_string(MODEL_FEATURE_COUNT) + " features";
+        for (uint32_t f = 0; f < featureCount; ++f)
+        {
+            std::string name;
+            if (!reader.text(name))
+                return "truncated feature names";
+            const char *expected = RECORD_SCHEMA[MODEL_FEATURE_FIELDS[f]].jsonKey;
+            if (name != expected)
+                return "feature " + std::to_string(f) + " is \"" + name + "\", this build expects \"" + expected +
+                       "\"";
+        }
+
+        if (!reader.u32(classCount) || classCount == 0 || classCount > size)
+            return "bad class count";
+        std::vector<std::string> labels(classCount);
+        std::vector<int> codes(classCount);
+        for (uint32_t c = 0; c < classCount; ++c)
+        {
+            if (!reader.text(labels[c]))
+                return "truncated class labels";
+            codes[c] = attackTypeFromLabel(labels[c]);
+            if (codes[c] < 0)
+                return "class \"" + labels[c] + "\" is not an attack type";
+        }
+
+        if (!reader.u32(sectionCount) || sectionCount > size / 24)
+            return "bad section count";
+        size_t headerEnd = reader.position() + static_cast<size_t>(sectionCount) * 24;
+        Section sections[NATIVE_MODEL_SECTION_LIMIT + 1];
+        for (uint32_t s = 0; s < sectionCount; ++s)
+        {
+            uint32_t id, reserved;
+            uint64_t offset, length;
+            if (!reader.u32(id) || !reader.u32(reserved) || !reader.u64(offset) || !reader.u64(length))
+                return "truncated section table";
+            if (offset % NATIVE_MODEL_SECTION_ALIGNMENT != 0 || offset < headerEnd || offset > size ||
+                length > size - offset)
+                return "section " + std::to_string(id) + " is out of bounds";
+            if (id == 0 || id > NATIVE_MODEL_SECTION_LIMIT)
+                continue;
+            if (sections[id].data)
+                return "section " + std::to_string(id) + " appears twice";
+            sections[id] = {data + offset, static_cast<size_t>(length)};
+        }
+        auto section = [&sections](NativeModelSection id) -> const Section &
+        { return sections[static_cast<uint32_t>(id)]; };
+
+        NativeModelKind modelKind = static_cast<NativeModelKind>(kindValue);
+        DecisionTree modelTree;
+        TreeEnsemble modelForest;
+        NearestCentroid modelCentroids;
+        std::vector<uint32_t> modelClusterClasses;
+        FeaturePreprocessor modelPreprocessor;
+        double modelPathLength = 0.0;
+        const TreeNode *nodes;
+        size_t nodeCount;
+        if (modelKind == NativeModelKind::DECISION_TREE)
+        {
+            if (section(NativeModelSection::IMPUTER).data || section(NativeModelSection::SCALER).data)
+                return "decision trees take raw features";
+            if (!sectionArray(section(NativeModelSection::NODES), nodes, nodeCount) ||
+                !modelTree.assign(nodes, nodeCount, featureCount, classCount))
+                return "malformed tree";
+        }
+        else
+        {
+            const double *values;
+            size_t valueCount;
+            if (section(NativeModelSection::IMPUTER).data)
+            {
+                if (!sectionArray(section(NativeModelSection::IMPUTER), values, valueCount) ||
+                    valueCount != featureCount)
+                    return "malformed imputer";
+                modelPreprocessor.setImputer(std::vector<double>(values, values + featureCount));
+            }
+            if (section(NativeModelSection::SCALER).data)
+            {
+                if (!sectionArray(section(NativeModelSection::SCALER), values, valueCount) ||
+                    valueCount != 2 * static_cast<size_t>(featureCount))
+                    return "malformed scaler";
+                modelPreprocessor.setScaler(std::vector<double>(values, values + featureCount),
+                                            std::vector<double>(values + featureCount, values + valueCount));
+            }
+
+            if (modelKind == NativeModelKind::KMEANS)
+            {
+                const uint32_t *clusters;
+                size_t clusterCount;
+                if (!sectionArray(section(NativeModelSection::CLUSTER_CLASSES), clusters, clusterCount) ||
+                    !sectionArray(section(NativeModelSection::CENTERS), values, valueCount) ||
+                    valueCount != clusterCount * featureCount)
+                    return "malformed clusters";
+                for (size_t k = 0; k < clusterCount; ++k)
+                    if (clusters[k] >= classCount)
+                        return "cluster class out of range";
+                modelClusterClasses.assign(clusters, clusters + clusterCount);
+                if (!modelCentroids.assign(std::vector<double>(values, values + valueCount), featureCount))
+                    return "malformed clusters";
+            }
+            else
+            {
+                bool isolation = modelKind == NativeModelKind::ISOLATION_FOREST;
+                if (isolation && classCount != 2)
+                    return "isolation forest needs two classes";
+                const uint32_t *leafRows;
+                const TreeEnsemble::Tree *trees;
+                size_t leafRowCount, treeCount;
+                if (!sectionArray(section(NativeModelSection::NODES), nodes, nodeCount) ||
+                    !sectionArray(section(NativeModelSection::LEAF_ROWS), leafRows, leafRowCount) ||
+                    !sectionArray(section(NativeModelSection::TREES), trees, treeCount) ||
+                    !sectionArray(section(NativeModelSection::LEAF_VALUES), values, valueCount) ||
+                    leafRowCount != nodeCount ||
+                    !modelForest.assign(nodes, nodeCount, leafRows, trees, treeCount, values, valueCount,
+                                        featureCount, isolation ? 1 : classCount))
+                    return "malformed forest";
+                if (isolation)
+                {
+                    const double *normalizer;
+                    size_t normalizerCount;
+                    if (!sectionArray(section(NativeModelSection::PATH_NORMALIZER), normalizer, normalizerCount) ||
+                        normalizerCount != 1)
+                        return "missing path length normalizer";
+                    modelPathLength = *normalizer;
+                }
+            }
+        }
+
+        kind = modelKind;
+        tree = modelTree;
+        forest = modelForest;
+        centroids = std::move(modelCentroids);
+        clusterClasses = std::move(modelClusterClasses);
+        preprocessor = std::move(modelPreprocessor);
+        maxSamplesPathLength = modelPathLength;
+        classLabels = std::move(labels);
+        classCodes = std::move(codes);
+        return "";
+#endif
+    }
+
+    // Views a whole, non-empty section as an array of T; false when it is
+    // missing or not a whole number of elements. Section offsets are
+    // aligned and the mapping starts on a page, so the elements are too.
+    template <typename T>
+    static bool sectionArray(const Section &section, const T *&values, size_t &count)
+    {
+        if (!section.data || section.size == 0 || section.size % sizeof(T) != 0)
+            return false;
+        values = reinterpret_cast<const T *>(section.data);
+        count = section.size / sizeof(T);
+        return true;
+    }
+
+    // Preprocesses the rows as the model was trained and sums the leaf rows
+    // every forest tree sends them to.
+    void forestSums(const float *features, size_t count, std::vector<double> &sums) const
+    {
+        std::vector<float> transformed;
+        if (!preprocessor.empty())
+        {
+            transformed.resize(count * MODEL_FEATURE_COUNT);
+            preprocessor.apply(features, transformed.data(), count, MODEL_FEATURE_COUNT);
+            features = transformed.data();
+        }
+        sums.resize(count * forest.rowWidth());
+        forest.sum(features, count, sums.data());
+    }
+
+    // score_samples() from a record's summed path lengths, in sklearn's
+    // order of operations: -2^(-depths / (trees * c(max_samples))).
+    double anomalyScore(double depths) const
+    {
+        double denominator = static_cast<double>(forest.treeCount()) * maxSamplesPathLength;
+        double ratio = denominator != 0.0 ? depths / denominator : 1.0;
+        return -std::pow(2.0, -ratio);
+    }
+
+    MappedFile mapping; // backs tree and forest
+    NativeModelKind kind = NativeModelKind::DECISION_TREE;
+    DecisionTree tree;
+    TreeEnsemble forest;
+    NearestCentroid centroids;
+    std::vector<uint32_t> clusterClasses; // class index per KMeans cluster
+    FeaturePreprocessor preprocessor;
+    double maxSamplesPathLength = 0.0;
+    std::vector<std::string> classLabels;
+    std::vector<int> classCodes;
+};
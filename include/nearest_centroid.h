@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Nearest-center search of a fitted KMeans model, a block of records at a
+// time.
+//
+// Each block is transposed into one contiguous run of BLOCK values per
+// feature, so a record's squared distance to a center builds up feature by
+// feature with the same subtract, multiply and add across the whole block,
+// and the running minimum is a compare and select per record. Every inner
+// loop is straight-line arithmetic over contiguous doubles, which the
+// compiler vectorizes; the centers themselves stay in registers or L1.
+//
+// Distances are summed directly as sum((x - c)^2) rather than sklearn's
+// ||c||^2 - 2 x.c, which is the same ordering without the cancellation.
+// Ties go to the lower cluster index, as in KMeans.predict.
+class NearestCentroid
+{
+public:
+    static constexpr size_t BLOCK = 64;
+    static constexpr size_t TAIL_BLOCK = 8; // rows left over after the full blocks go in these
+
+    // Takes the cluster centers row by row, featureCount coordinates each.
+    bool assign(std::vector<double> clusterCenters, uint32_t featureCount)
+    {
+        if (featureCount == 0 || clusterCenters.empty() || clusterCenters.size() % featureCount != 0)
+            return false;
+        centers = std::move(clusterCenters);
+        features = featureCount;
+        return true;
+    }
+
+    // Nearest center of each of count rows of featureCount doubles, and the
+    // Euclidean distance to it. A row containing NaN gets cluster 0 and an
+    // infinite distance.
+    void nearest(const double *rows, size_t count, uint32_t *clusters, double *distances) const
+    {
+        std::vector<double> columns(static_cast<size_t>(features) * (count >= BLOCK ? BLOCK : TAIL_BLOCK));
+        size_t first = 0;
+        for (; first + BLOCK <= count; first += BLOCK)
+            nearestBlock<BLOCK>(rows + first * features, BLOCK, columns.data(), clusters + first, distances + first);
+        for (; first < count; first += TAIL_BLOCK)
+        {
+            size_t n = std::min(TAIL_BLOCK, count - first);
+            nearestBlock<TAIL_BLOCK>(rows + first * features, n, columns.data(), clusters + first, distances + first);
+        }
+    }
+
+    size_t clusterCount() const { return features ? centers.size() / features : 0; }
+
+private:
+    // Searches n <= Rows records. A short block is padded with zeros so that
+    // every inner loop runs exactly Rows times.
+    template <size_t Rows>
+    void nearestBlock(const double *block, size_t n, double *columns, uint32_t *clusters, double *distances) const
+    {
+        if (n < Rows)
+            std::fill(columns, columns + features * Rows, 0.0);
+        for (size_t r = 0; r < n; ++r)
+        {
+            for (uint32_t f = 0; f < features; ++f)
+                columns[f * Rows + r] = block[r * features + f];
+        }
+
+        double sums[Rows], best[Rows];
+        uint32_t labels[Rows];
+        std::fill(best, best + Rows, std::numeric_limits<double>::infinity());
+        std::fill(labels, labels + Rows, 0u);
+        size_t clusterCount = centers.size() / features;
+        for (size_t k = 0; k < clusterCount; ++k)
+        {
+            const double *center = &centers[k * features];
+            std::fill(sums, sums + Rows, 0.0);
+            for (uint32_t f = 0; f < features; ++f)
+            {
+                const double *column = &columns[f * Rows];
+                double c = center[f];
+                for (size_t r = 0; r < Rows; ++r)
+                {
+                    double d = column[r] - c;
+                    sums[r] += d * d;
+                }
+            }
+            uint32_t label = static_cast<uint32_t>(k);
+            for (size_t r = 0; r < Rows; ++r)
+            {
+                bool closer = sums[r] < best[r];
+                best[r] = closer ? sums[r] : best[r];
+                labels[r] = closer ? label : labels[r];
+            }
+        }
+
+        for (size_t r = 0; r < n; ++r)
+        {
+            clusters[r] = labels[r];
+            distances[r] = std::sqrt(best[r]);
+        }
+    }
+
+    std::vector<double> centers; // features coordinates per cluster
+    uint32_t features = 0;
+};
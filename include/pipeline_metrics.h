@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rolling window of the most recent frame times, in milliseconds. Used to
+// show that UI frame cost stays flat while the ingest rate changes.
+class FrameTimeWindow
+{
+public:
+    explicit FrameTimeWindow(size_t capacity = 240) : samples(capacity, 0.0f) {}
+
+    void add(float milliseconds)
+    {
+        samples[next] = milliseconds;
+        next = (next + 1) % samples.size();
+        count = std::min(count + 1, samples.size());
+    }
+
+    float average() const
+    {
+        if (count == 0)
+            return 0.0f;
+        float sum = 0.0f;
+        for (size_t i = 0; i < count; ++i)
+            sum += samples[i];
+        return sum / static_cast<float>(count);
+    }
+
+    float worst() const
+    {
+        float result = 0.0f;
+        for (size_t i = 0; i < count; ++i)
+            result = std::max(result, samples[i]);
+        return result;
+    }
+
+    // fraction in [0, 1], e.g. 0.99 for the 99th percentile.
+    float percentile(float fraction) const
+    {
+        if (count == 0)
+            return 0.0f;
+        std::vector<float> sorted(samples.begin(), samples.begin() + count);
+        size_t rank = static_cast<size_t>(fraction * static_cast<float>(count - 1) + 0.5f);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        return sorted[rank];
+    }
+
+private:
+    std::vector<float> samples;
+    size_t next = 0;
+    size_t count = 0;
+};
+
+// Turns a monotonically increasing counter into a per-second rate,
+// recomputed at most once per interval.
+class RateMeter
+{
+public:
+    explicit RateMeter(std::chrono::milliseconds interval = std::chrono::milliseconds(1000))
+        : interval(interval) {}
+
+    // Returns true when a new rate was computed.
+    bool update(uint64_t total, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now())
+    {
+        if (!started)
+        {
+            started = true;
+            lastTotal = total;
+            lastTime = now;
+            return false;
+        }
+        auto elapsed = now - lastTime;
+        if (elapsed < interval)
+            return false;
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        currentRate = static_cast<double>(total - lastTotal) / seconds;
+        lastTotal = total;
+        lastTime = now;
+        return true;
+    }
+
+    double rate() const { return currentRate; }
+
+private:
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point lastTime;
+    uint64_t lastTotal = 0;
+    double currentRate = 0.0;
+    bool started = false;
+};
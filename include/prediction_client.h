@@ -0,0 +1,400 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "line_framer.h"
+#include "socket_compat.h"
+
+// Pipelined, non-blocking connection to one prediction_script.py.
+//
+// Messages are JSON objects, one per line. Every prediction request carries
+// an "id" that the script echoes in its answer, and up to window() requests
+// are on the wire at once, so the script scores them back to back instead
+// of idling a round trip per record. Requests beyond the window wait in a
+// local queue and go out as answers come back; once MAX_QUEUED records are
+// waiting, new ones are dropped and counted, so a model slower than the
+// feed falls behind without ever holding the feed up.
+//
+// Records are grouped into batch requests, {"id":N,"records":[...]}, which
+// the script scores with one model call and answers with a "predictions"
+// array in record order. A batch goes out once it holds the batch size or
+// its first record is older than the batch delay, whichever comes first; a
+// batch of one is sent as the plain record. Batch size 1 (the default)
+// sends every record on its own.
+//
+// A request left unanswered past the timeout is given up on and the
+// connection counts as stalled: queued and new requests are dropped until
+// the script answers anything again, so a hung script costs neither memory
+// nor time. Control messages (get_stats, save_model) queue behind the
+// predictions already submitted and are answered by a line with no "id".
+//
+// Only command() blocks, for at most its timeout. The socket stays owned by
+// the caller. One thread at a time.
+class PredictionClient
+{
+public:
+    static constexpr size_t MAX_QUEUED = 1 << 16;
+    static constexpr std::chrono::milliseconds DEFAULT_TIMEOUT{2000};
+
+    // An answer and the record it belongs to.
+    struct Completion
+    {
+        size_t connectionId;
+        double timestamp;
+        float prediction;
+    };
+
+    // socket must be connected and non-blocking; name is used in logs.
+    PredictionClient(SOCKET socket, std::string name, size_t window)
+        : sock(socket), modelName(std::move(name)), limit(window < 1 ? 1 : window)
+    {
+    }
+
+    void setWindow(size_t window) { limit = window < 1 ? 1 : window; }
+    size_t window() const { return limit; }
+    // Longest a sent request may go unanswered.
+    void setTimeout(std::chrono::milliseconds value) { timeout = value; }
+    // Most records per request, and longest the first of them may wait for
+    // the rest.
+    void setBatching(size_t records, std::chrono::milliseconds delay)
+    {
+        batchLimit = records < 1 ? 1 : records;
+        batchDelay = delay;
+        if (batch.size() >= batchLimit)
+            closeBatch();
+    }
+
+    // Queues the record in body, a JSON object, for prediction. Returns
+    // false if it was dropped because the queue is full or the connection
+    // is stalled or gone.
+    bool submit(const std::string &body, size_t connectionId, double timestamp)
+    {
+        if (closed || stalled || queuedRecords >= MAX_QUEUED)
+        {
+            ++droppedCount;
+            return false;
+        }
+        if (batch.empty())
+            batchStart = std::chrono::steady_clock::now();
+        else
+            batchBodies += ',';
+        batchBodies += body;
+        batch.push_back({connectionId, timestamp});
+        ++queuedRecords;
+        if (batch.size() >= batchLimit)
+            closeBatch();
+        return true;
+    }
+
+    // Sends what the window allows, gives up on requests past the timeout,
+    // and hands every answer received so far to
+    // onCompletion(const Completion &). Returns the number of answers.
+    template <typename OnCompletion>
+    size_t poll(OnCompletion &&onCompletion)
+    {
+        if (!batch.empty() && std::chrono::steady_clock::now() - batchStart >= batchDelay)
+            closeBatch();
+        send();
+        size_t completed = receive(onCompletion);
+        expire();
+        if (completed > 0)
+            send();
+        return completed;
+    }
+
+    // Queues a control message, body being a JSON object; poll() until
+    // replyReady().
+    void startCommand(const std::string &body)
+    {
+        closeBatch();
+        hasReply = false;
+        commandLine = body + '\n';
+    }
+
+    bool replyReady() const { return hasReply; }
+
+    std::string takeReply()
+    {
+        hasReply = false;
+        return std::move(lastReply);
+    }
+
+    // startCommand(), then polls until the reply arrives or limit passes.
+    template <typename OnCompletion>
+    bool command(const std::string &body, std::string &reply, OnCompletion &&onCompletion,
+                 std::chrono::milliseconds limit)
+    {
+        auto deadline = std::chrono::steady_clock::now() + limit;
+        startCommand(body);
+        while (true)
+        {
+            poll(onCompletion);
+            if (hasReply)
+            {
+                reply = takeReply();
+                return true;
+            }
+            if (closed || std::chrono::steady_clock::now() >= deadline)
+                return false;
+            // Wakes for the next expiry too, so a stall is noticed on time.
+            auto wake = deadline;
+            if (!pending.empty())
+                wake = std::min(wake, pending.front().sentAt + timeout);
+            if (!waitReady(wake) && wake == deadline)
+                return false;
+        }
+    }
+
+    bool connected() const { return !closed; }
+    // Requests sent and not yet answered.
+    size_t inFlight() const { return pending.size(); }
+    // Records not sent yet.
+    size_t queued() const { return queuedRecords; }
+    uint64_t dropped() const { return droppedCount; }
+    uint64_t timedOut() const { return timedOutCount; }
+
+private:
+    struct RecordRef
+    {
+        size_t connectionId;
+        double timestamp;
+    };
+
+    struct Pending
+    {
+        uint64_t id;
+        std::vector<RecordRef> records;
+        std::chrono::steady_clock::time_point sentAt;
+    };
+
+    struct Queued
+    {
+        Pending request;
+        std::string line;
+    };
+
+#ifdef MSG_NOSIGNAL
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL; // a dead script must not raise SIGPIPE
+#else
+    static constexpr int SEND_FLAGS = 0;
+#endif
+
+    // Turns the records gathered so far into one request.
+    void closeBatch()
+    {
+        if (batch.empty())
+            return;
+        uint64_t id = nextId++;
+        std::string line = "{\"id\":" + std::to_string(id);
+        if (batch.size() == 1)
+        {
+            if (batchBodies.size() > 2)
+                line += ',';
+            line.append(batchBodies, 1, std::string::npos);
+        }
+        else
+        {
+            line += ",\"records\":[";
+            line += batchBodies;
+            line += "]}";
+        }
+        line += '\n';
+        waiting.push_back({{id, std::move(batch), {}}, std::move(line)});
+        batch.clear();
+        batchBodies.clear();
+    }
+
+    void send()
+    {
+        auto now = std::chrono::steady_clock::now();
+        while (!closed && !waiting.empty() && pending.size() < limit)
+        {
+            outbox += waiting.front().line;
+            queuedRecords -= waiting.front().request.records.size();
+            pending.push_back(std::move(waiting.front().request));
+            pending.back().sentAt = now;
+            waiting.pop_front();
+        }
+        if (!commandLine.empty() && waiting.empty())
+        {
+            outbox += commandLine;
+            commandLine.clear();
+        }
+        while (!closed && sent < outbox.size())
+        {
+            int n = ::send(sock, outbox.data() + sent, static_cast<int>(outbox.size() - sent), SEND_FLAGS);
+            if (n == SOCKET_ERROR)
+            {
+                if (!socketWouldBlock())
+                    fail("send failed with error " + std::to_string(WSAGetLastError()));
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        if (sent == outbox.size())
+        {
+            outbox.clear();
+            sent = 0;
+        }
+    }
+
+    template <typename OnCompletion>
+    size_t receive(OnCompletion &onCompletion)
+    {
+        size_t completed = 0;
+        char buffer[16384];
+        while (!closed)
+        {
+            int n = ::recv(sock, buffer, sizeof(buffer), 0);
+            if (n > 0)
+            {
+                framer.feed(buffer, static_cast<size_t>(n), [&](const char *line, size_t length)
+                            { return deliver(line, length, onCompletion, completed); });
+                continue;
+            }
+            if (n == 0)
+                fail("connection closed by the prediction script");
+            else if (!socketWouldBlock())
+                fail("recv failed with error " + std::to_string(WSAGetLastError()));
+            break;
+        }
+        return completed;
+    }
+
+    template <typename OnCompletion>
+    bool deliver(const char *line, size_t length, OnCompletion &onCompletion, size_t &completed)
+    {
+        nlohmann::json message = nlohmann::json::parse(line, line + length, nullptr, false);
+        if (message.is_discarded() || !message.is_object())
+            return false;
+        auto id = message.find("id");
+        if (id == message.end())
+        {
+            lastReply.assign(line, length);
+            hasReply = true;
+            return true;
+        }
+        if (!id->is_number_unsigned())
+            return false;
+        // Whatever it answers, the script is making progress again.
+        stalled = false;
+        // The script answers in order, so this is almost always the front.
+        uint64_t value = id->get<uint64_t>();
+        auto match = pending.begin();
+        while (match != pending.end() && match->id != value)
+            ++match;
+        if (match == pending.end())
+            return value < nextId; // an answer that came after its timeout
+        Pending request = std::move(*match);
+        pending.erase(match);
+        auto predictions = message.find("predictions");
+        bool batched = predictions != message.end() && predictions->is_array();
+        for (size_t r = 0; r < request.records.size(); ++r)
+        {
+            float prediction = 0.0f;
+            if (batched && r < predictions->size() && (*predictions)[r].is_number())
+                prediction = (*predictions)[r].get<float>();
+            else if (!batched)
+                prediction = message.value("prediction", 0.0f);
+            onCompletion(Completion{request.records[r].connectionId, request.records[r].timestamp, prediction});
+        }
+        completed += request.records.size();
+        return true;
+    }
+
+    // Requests go out in order, so the expired ones are at the front.
+    void expire()
+    {
+        auto cutoff = std::chrono::steady_clock::now() - timeout;
+        size_t expired = 0;
+        while (!pending.empty() && pending.front().sentAt < cutoff)
+        {
+            expired += pending.front().records.size();
+            pending.pop_front();
+        }
+        if (expired == 0)
+            return;
+        timedOutCount += expired;
+        if (!stalled)
+            std::cerr << modelName << " did not answer within " << timeout.count()
+                      << " ms; skipping records until it does" << std::endl;
+        stalled = true;
+        dropQueued();
+    }
+
+    void dropQueued()
+    {
+        droppedCount += queuedRecords;
+        queuedRecords = 0;
+        waiting.clear();
+        batch.clear();
+        batchBodies.clear();
+    }
+
+    // Sleeps until the socket can make progress or the deadline passes.
+    bool waitReady(std::chrono::steady_clock::time_point deadline) const
+    {
+        auto remaining =
+            std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+            return false;
+        fd_set readSet, writeSet;
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_SET(sock, &readSet);
+        if (sent < outbox.size())
+            FD_SET(sock, &writeSet);
+        timeval wait;
+        wait.tv_sec = static_cast<long>(remaining.count() / 1000000);
+        wait.tv_usec = static_cast<long>(remaining.count() % 1000000);
+        return select(static_cast<int>(sock + 1), &readSet, &writeSet, nullptr, &wait) >= 0;
+    }
+
+    void fail(const std::string &reason)
+    {
+        closed = true;
+        size_t lost = queuedRecords;
+        for (const Pending &request : pending)
+            lost += request.records.size();
+        droppedCount += lost - queuedRecords;
+        dropQueued();
+        pending.clear();
+        outbox.clear();
+        commandLine.clear();
+        sent = 0;
+        std::cerr << "Prediction connection to " << modelName << " lost (" << reason << "), " << lost
+                  << " records unanswered" << std::endl;
+    }
+
+    SOCKET sock;
+    std::string modelName;
+    size_t limit;
+    std::chrono::milliseconds timeout = DEFAULT_TIMEOUT;
+    size_t batchLimit = 1;
+    std::chrono::milliseconds batchDelay{0};
+    uint64_t nextId = 0;
+    std::deque<Pending> pending;  // sent, awaiting an answer, oldest first
+    std::deque<Queued> waiting;   // not yet sent, held back by the window
+    std::vector<RecordRef> batch; // records of the request being gathered
+    std::string batchBodies;      // their JSON, comma separated
+    std::chrono::steady_clock::time_point batchStart;
+    size_t queuedRecords = 0;     // in waiting and batch
+    std::string outbox;           // bytes the socket has not taken yet
+    size_t sent = 0;              // of outbox
+    std::string commandLine;      // control message waiting for the queue to empty
+    LineFramer framer;
+    std::string lastReply;
+    bool hasReply = false;
+    bool closed = false;
+    bool stalled = false; // a request timed out and nothing has been answered since
+    uint64_t droppedCount = 0;
+    uint64_t timedOutCount = 0;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "feature_schema.h"
+
+// Confusion counts per attack type and prediction timing for one model,
+// kept the same way as ModelStats in prediction_script.py so that native
+// and Python models report comparable numbers.
+class PredictionStats
+{
+public:
+    struct Counts
+    {
+        uint64_t tp = 0, fp = 0, tn = 0, fn = 0;
+    };
+
+    // predicted and actual are attack type codes (see attackTypeCode()).
+    void update(int predicted, int actual)
+    {
+        ++predictionCount;
+        ++actualCounts[actual];
+        if (predicted == actual)
+        {
+            ++counts[predicted].tp;
+        }
+        else
+        {
+            ++counts[predicted].fp;
+            ++counts[actual].fn;
+        }
+        for (size_t type = 0; type < ATTACK_TYPE_COUNT; ++type)
+        {
+            if (static_cast<int>(type) != predicted && static_cast<int>(type) != actual)
+                ++counts[type].tn;
+        }
+    }
+
+    // Time spent predicting, added once per batch.
+    void addTime(double seconds) { totalSeconds += seconds; }
+
+    // Anomaly score of one prediction, for models that produce one.
+    void addScore(double score)
+    {
+        ++scoreCount;
+        scoreSum += score;
+        scoreMin = std::min(scoreMin, score);
+        scoreMax = std::max(scoreMax, score);
+    }
+
+    uint64_t predictions() const { return predictionCount; }
+    uint64_t support(size_t type) const { return actualCounts[type]; }
+    const Counts &confusion(size_t type) const { return counts[type]; }
+    double averageMilliseconds() const
+    {
+        return predictionCount > 0 ? totalSeconds * 1000.0 / static_cast<double>(predictionCount) : 0.0;
+    }
+    uint64_t scores() const { return scoreCount; }
+    double averageScore() const { return scoreCount > 0 ? scoreSum / static_cast<double>(scoreCount) : 0.0; }
+    double minScore() const { return scoreMin; }
+    double maxScore() const { return scoreMax; }
+
+private:
+    Counts counts[ATTACK_TYPE_COUNT];
+    uint64_t actualCounts[ATTACK_TYPE_COUNT] = {};
+    uint64_t predictionCount = 0;
+    double totalSeconds = 0.0;
+    uint64_t scoreCount = 0;
+    double scoreSum = 0.0;
+    double scoreMin = std::numeric_limits<double>::infinity();
+    double scoreMax = -std::numeric_limits<double>::infinity();
+};
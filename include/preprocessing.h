@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// SimpleImputer and StandardScaler as fitted in the training scripts,
+// applied in that order: a NaN feature takes the imputer's statistic, then
+// z = (x - mean) / scale. Both run in double and round once to the output
+// type, the same steps sklearn takes on the float64 rows
+// prediction_script.py passes them (the trees then cast to float32). Either
+// stage may be absent; with neither, the model takes raw features.
+class FeaturePreprocessor
+{
+public:
+    void setImputer(std::vector<double> statistics) { fill = std::move(statistics); }
+
+    void setScaler(std::vector<double> scalerMean, std::vector<double> scalerScale)
+    {
+        mean = std::move(scalerMean);
+        scale = std::move(scalerScale);
+    }
+
+    bool empty() const { return fill.empty() && mean.empty(); }
+
+    // Transforms count rows of featureCount values from in to out.
+    template <typename T>
+    void apply(const float *in, T *out, size_t count, size_t featureCount) const
+    {
+        for (size_t r = 0; r < count; ++r)
+        {
+            for (size_t f = 0; f < featureCount; ++f)
+            {
+                double value = in[r * featureCount + f];
+                if (!fill.empty() && value != value)
+                    value = fill[f];
+                if (!mean.empty())
+                    value = (value - mean[f]) / scale[f];
+                out[r * featureCount + f] = static_cast<T>(value);
+            }
+        }
+    }
+
+private:
+    std::vector<double> fill; // imputer statistic per feature
+    std::vector<double> mean;
+    std::vector<double> scale;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Number of values in one data point and the index of the wall-clock stamp,
+// in the column order send_to_cpp() uses.
+constexpr size_t RECORD_FIELD_COUNT = 20;
+constexpr size_t RECORD_TIMESTAMP_FIELD = 14;
+
+// One data point, field for field in send_to_cpp()'s column order. Every
+// value is a float except the wall-clock timestamp, which needs a double to
+// keep sub-millisecond resolution.
+//
+// The layout is the binary wire payload with float32 encoding (see
+// binary_record.h), so on little-endian hosts a frame decodes with a single
+// memcpy. The static_asserts below keep the two in step.
+struct Record
+{
+    float fb;                       //  0 FB
+    float tb;                       //  1 TB
+    float iat;                      //  2 IAT
+    float td;                       //  3 TD
+    float arrivalTime;              //  4 Arrival Time
+    float pc;                       //  5 PC
+    float packetSize;               //  6 Packet Size
+    float ackPacketSize;            //  7 Acknowledgement Packet Size
+    float rtt;                      //  8 RTT
+    float averageQueueSize;         //  9 Average Queue Size
+    float systemOccupancy;          // 10 System Occupancy
+    float arrivalRate;              // 11 Arrival Rate
+    float serviceRate;              // 12 Service Rate
+    float packetDropped;            // 13 Packet Dropped
+    double timestamp;               // 14 wall-clock time.time() at send
+    float sample;                   // 15 Sample
+    float attackNone;               // 16 attack_none
+    float attackDdos;               // 17 attack_ddos
+    float attackSynflood;           // 18 attack_synflood
+    float attackMitm;               // 19 attack_mitm
+
+    double field(size_t index) const;
+    void setField(size_t index, double value);
+};
+
+// Byte offset of each field inside Record and inside a float32 payload.
+constexpr size_t recordFieldOffset(size_t index)
+{
+    return index < RECORD_TIMESTAMP_FIELD    ? index * 4
+           : index == RECORD_TIMESTAMP_FIELD ? RECORD_TIMESTAMP_FIELD * 4
+                                             : index * 4 + 4;
+}
+
+constexpr size_t RECORD_PAYLOAD_SIZE = recordFieldOffset(RECORD_FIELD_COUNT - 1) + 4;
+
+static_assert(std::is_trivially_copyable<Record>::value, "Record must be trivially copyable");
+static_assert(std::is_standard_layout<Record>::value, "Record must be standard layout");
+static_assert(offsetof(Record, fb) == recordFieldOffset(0), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, tb) == recordFieldOffset(1), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, iat) == recordFieldOffset(2), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, td) == recordFieldOffset(3), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, arrivalTime) == recordFieldOffset(4), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, pc) == recordFieldOffset(5), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, packetSize) == recordFieldOffset(6), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, ackPacketSize) == recordFieldOffset(7), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, rtt) == recordFieldOffset(8), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, averageQueueSize) == recordFieldOffset(9), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, systemOccupancy) == recordFieldOffset(10), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, arrivalRate) == recordFieldOffset(11), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, serviceRate) == recordFieldOffset(12), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, packetDropped) == recordFieldOffset(13), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, timestamp) == recordFieldOffset(14), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, sample) == recordFieldOffset(15), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, attackNone) == recordFieldOffset(16), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, attackDdos) == recordFieldOffset(17), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, attackSynflood) == recordFieldOffset(18), "Record layout does not match the wire schema");
+static_assert(offsetof(Record, attackMitm) == recordFieldOffset(19), "Record layout does not match the wire schema");
+static_assert(sizeof(Record) >= RECORD_PAYLOAD_SIZE, "Record is smaller than the wire payload");
+
+inline double Record::field(size_t index) const
+{
+    const char *base = reinterpret_cast<const char *>(this) + recordFieldOffset(index);
+    if (index == RECORD_TIMESTAMP_FIELD)
+    {
+        double value;
+        std::memcpy(&value, base, sizeof(value));
+        return value;
+    }
+    float value;
+    std::memcpy(&value, base, sizeof(value));
+    return value;
+}
+
+inline void Record::setField(size_t index, double value)
+{
+    char *base = reinterpret_cast<char *>(this) + recordFieldOffset(index);
+    if (index == RECORD_TIMESTAMP_FIELD)
+    {
+        std::memcpy(base, &value, sizeof(value));
+        return;
+    }
+    float narrowed = static_cast<float>(value);
+    std::memcpy(base, &narrowed, sizeof(narrowed));
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "binary_record.h"
+#include "line_framer.h"
+
+// Per-connection decoder that picks the wire format from the first byte the
+// feeder sends: 0xA5 selects length-prefixed binary frames, anything else
+// newline-framed JSON.
+//
+// Binary frames that arrive whole are decoded straight from the receive
+// buffer. Only a frame split across reads is staged in a small buffer until
+// the rest of it arrives. After a corrupt header the stream skips ahead to
+// the next magic byte after the header's first and counts one framing error,
+// so a frame that follows the corruption within a read is still decoded.
+class RecordStream
+{
+public:
+    enum class Format
+    {
+        UNKNOWN,
+        JSON,
+        BINARY
+    };
+
+    // onJsonLine(const char *line, size_t len) -> bool
+    // onBinary(const BinaryRecordView &record)
+    template <typename OnJsonLine, typename OnBinary>
+    void feed(const char *data, size_t len, OnJsonLine &&onJsonLine, OnBinary &&onBinary)
+    {
+        if (len == 0)
+            return;
+        if (format_ == Format::UNKNOWN)
+        {
+            format_ = static_cast<unsigned char>(data[0]) == BINARY_RECORD_MAGIC0 ? Format::BINARY : Format::JSON;
+        }
+
+        if (format_ == Format::JSON)
+        {
+            lines.feed(data, len, onJsonLine);
+        }
+        else
+        {
+            feedBinary(data, len, onBinary);
+        }
+    }
+
+    Format format() const { return format_; }
+    uint64_t framingErrors() const { return lines.framingErrors() + binaryErrors; }
+
+private:
+    template <typename OnBinary>
+    void feedBinary(const char *data, size_t len, OnBinary &onBinary)
+    {
+        BinaryRecordView view;
+        size_t frameSize = 0;
+
+        // Finish a frame left over from the previous read.
+        while (!partial.empty() && len > 0)
+        {
+            size_t want = BINARY_RECORD_HEADER_SIZE - std::min(partial.size(), BINARY_RECORD_HEADER_SIZE);
+            if (want == 0)
+            {
+                // The staged header was validated when it was stored.
+                parseBinaryFrame(partial.data(), partial.size(), view, frameSize);
+                want = frameSize - partial.size();
+            }
+            size_t take = std::min(want, len);
+            partial.insert(partial.end(), data, data + take);
+            data += take;
+            len -= take;
+
+            FrameStatus status = parseBinaryFrame(partial.data(), partial.size(), view, frameSize);
+            if (status == FrameStatus::COMPLETE)
+            {
+                onBinary(view);
+                partial.clear();
+            }
+            else if (status == FrameStatus::INVALID)
+            {
+                // The staged bytes after the bad header's first may hold the
+                // next frame: scan them again, ahead of the rest of this
+                // read. Only happens on corruption, so the copy is cheap.
+                ++binaryErrors;
+                std::vector<char> rescan(partial.begin() + 1, partial.end());
+                rescan.insert(rescan.end(), data, data + len);
+                partial.clear();
+                resyncing = true;
+                feedBinary(rescan.data(), rescan.size(), onBinary);
+                return;
+            }
+        }
+
+        while (len > 0)
+        {
+            if (resyncing)
+            {
+                const char *magic = static_cast<const char *>(std::memchr(data, BINARY_RECORD_MAGIC0, len));
+                if (!magic)
+                    return;
+                len -= static_cast<size_t>(magic - data);
+                data = magic;
+                resyncing = false;
+            }
+
+            FrameStatus status = parseBinaryFrame(data, len, view, frameSize);
+            if (status == FrameStatus::COMPLETE)
+            {
+                onBinary(view);
+                data += frameSize;
+                len -= frameSize;
+            }
+            else if (status == FrameStatus::INCOMPLETE)
+            {
+                partial.assign(data, data + len);
+                return;
+            }
+            else
+            {
+                ++binaryErrors;
+                resyncing = true;
+                ++data;
+                --len;
+            }
+        }
+    }
+
+    Format format_ = Format::UNKNOWN;
+    LineFramer lines;
+    std::vector<char> partial;
+    bool resyncing = false;
+    uint64_t binaryErrors = 0;
+};
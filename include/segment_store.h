@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Append-only storage for plain values in memory-mapped scratch files.
+//
+// Space is handed out from fixed-size segment files, each mapped once for
+// the life of the store; a full segment is left as is and a new one is
+// opened. Pointers returned by append() therefore stay valid until the
+// store is destroyed, and the OS pages segment contents in and out on
+// demand instead of keeping them in process memory. The files are deleted
+// when the store goes away (or on POSIX, as soon as they are mapped), so
+// nothing is left behind after a crash.
+//
+// One writer thread; any thread may read data returned by append() once it
+// has been handed over with the usual release/acquire ordering.
+class SegmentStore
+{
+public:
+    explicit SegmentStore(std::filesystem::path directory, size_t segmentBytes = 64u << 20)
+        : directory(std::move(directory)), segmentBytes(segmentBytes)
+    {
+        std::random_device random;
+        prefix = "series-" + std::to_string(random()) + "-";
+    }
+
+    ~SegmentStore()
+    {
+        for (Segment &segment : segments)
+            unmap(segment);
+    }
+
+    SegmentStore(const SegmentStore &) = delete;
+    SegmentStore &operator=(const SegmentStore &) = delete;
+
+    // Copies count values into mapped storage and returns the copy, or
+    // nullptr if a new segment file could not be created.
+    template <typename T>
+    const T *append(const T *values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "segments hold raw bytes");
+        size_t bytes = count * sizeof(T);
+        size_t offset = 0;
+        if (!segments.empty())
+            offset = (segments.back().used + alignof(T) - 1) / alignof(T) * alignof(T);
+        if (segments.empty() || offset + bytes > segments.back().size)
+        {
+            Segment segment;
+            if (!map(segment, std::max(bytes, segmentBytes)))
+                return nullptr;
+            segments.push_back(segment);
+            offset = 0;
+        }
+        Segment &segment = segments.back();
+        T *copy = reinterpret_cast<T *>(segment.base + offset);
+        std::memcpy(copy, values, bytes);
+        segment.used = offset + bytes;
+        written += bytes;
+        return copy;
+    }
+
+    size_t bytesWritten() const { return written; }
+    size_t segmentCount() const { return segments.size(); }
+
+private:
+    struct Segment
+    {
+        char *base = nullptr;
+        size_t size = 0;
+        size_t used = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+    };
+
+    bool map(Segment &segment, size_t size)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        std::filesystem::path path = directory / (prefix + std::to_string(segments.size()) + ".seg");
+        segment.size = size;
+
+#ifdef _WIN32
+        segment.file = CreateFileW(path.wstring().c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+                                   FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+        if (segment.file == INVALID_HANDLE_VALUE)
+        {
+            std::cerr << "Failed to create segment file " << path.string() << ": " << GetLastError() << std::endl;
+            return false;
+        }
+        uint64_t size64 = size;
+        segment.mapping = CreateFileMappingW(segment.file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                             static_cast<DWORD>(size64), nullptr);
+        if (segment.mapping)
+            segment.base = static_cast<char *>(MapViewOfFile(segment.mapping, FILE_MAP_WRITE, 0, 0, size));
+        if (!segment.base)
+        {
+            std::cerr << "Failed to map segment file " << path.string() << ": " << GetLastError() << std::endl;
+            unmap(segment);
+            return false;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+        {
+            std::cerr << "Failed to create segment file " << path.string() << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        void *base = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+            base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED)
+            std::cerr << "Failed to map segment file " << path.string() << ": " << std::strerror(errno) << std::endl;
+        // The mapping keeps the data alive; the name is not needed again.
+        ::unlink(path.c_str());
+        ::close(fd);
+        if (base == MAP_FAILED)
+            return false;
+        segment.base = static_cast<char *>(base);
+#endif
+        return true;
+    }
+
+    static void unmap(Segment &segment)
+    {
+#ifdef _WIN32
+        if (segment.base)
+            UnmapViewOfFile(segment.base);
+        if (segment.mapping)
+            CloseHandle(segment.mapping);
+        if (segment.file != INVALID_HANDLE_VALUE)
+            CloseHandle(segment.file);
+#else
+        if (segment.base)
+            ::munmap(segment.base, segment.size);
+#endif
+        segment.base = nullptr;
+    }
+
+    std::filesystem::path directory;
+    size_t segmentBytes;
+    std::string prefix;
+    std::vector<Segment> segments;
+    size_t written = 0;
+};
@@ -0,0 +1,619 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "minmax_pyramid.h"
+#include "segment_store.h"
+
+// Rows per spilled chunk (see SeriesStore::enableSpill).
+constexpr size_t SPILL_CHUNK_ROWS = 1024;
+
+// The spilled rows of one column, oldest first: sealed chunks in mapped
+// segment files, then the chunk still being filled in memory.
+struct SpilledColumn
+{
+    const float *const *chunks = nullptr; // per chunk: columns * SPILL_CHUNK_ROWS floats
+    const float *chunkMins = nullptr;     // per chunk: min of each column
+    const float *chunkMaxs = nullptr;
+    size_t chunkCount = 0;
+    size_t column = 0;
+    size_t columns = 1;
+    const double *const *chunkTimes = nullptr; // per chunk: SPILL_CHUNK_ROWS timestamps
+    const float *staging = nullptr;            // columns * SPILL_CHUNK_ROWS floats
+    const double *stagingTimes = nullptr;
+    size_t stagingRows = 0;
+
+    size_t size() const { return chunkCount * SPILL_CHUNK_ROWS + stagingRows; }
+
+    float operator[](size_t row) const
+    {
+        return chunkColumn(row / SPILL_CHUNK_ROWS)[row % SPILL_CHUNK_ROWS];
+    }
+
+    double time(size_t row) const
+    {
+        size_t chunk = row / SPILL_CHUNK_ROWS;
+        const double *times = chunk < chunkCount ? chunkTimes[chunk] : stagingTimes;
+        return times[row % SPILL_CHUNK_ROWS];
+    }
+
+    // Widens min/max over rows [first, last), reading only the chunks that
+    // are cut by the range ends.
+    void range(size_t first, size_t last, float &min, float &max) const
+    {
+        while (first < last)
+        {
+            size_t chunk = first / SPILL_CHUNK_ROWS;
+            size_t chunkFirst = chunk * SPILL_CHUNK_ROWS;
+            size_t chunkLast = std::min(last, chunkFirst + SPILL_CHUNK_ROWS);
+            if (chunk < chunkCount && first == chunkFirst && chunkLast == chunkFirst + SPILL_CHUNK_ROWS)
+            {
+                min = std::min(min, chunkMins[chunk * columns + column]);
+                max = std::max(max, chunkMaxs[chunk * columns + column]);
+            }
+            else
+            {
+                const float *values = chunkColumn(chunk);
+                for (size_t row = first; row < chunkLast; ++row)
+                {
+                    float value = values[row - chunkFirst];
+                    min = value < min ? value : min;
+                    max = value > max ? value : max;
+                }
+            }
+            first = chunkLast;
+        }
+    }
+
+private:
+    const float *chunkColumn(size_t chunk) const
+    {
+        const float *base = chunk < chunkCount ? chunks[chunk] : staging;
+        return base + column * SPILL_CHUNK_ROWS;
+    }
+};
+
+// One column of one connection. The newest rows sit in a ring with the
+// oldest at offset (data, count, offset); when the store spills, the rows
+// pushed out of the ring come before it. Index 0 is the oldest row still
+// readable from either tier. Every row carries the timestamp it was
+// appended with, non-decreasing along the column.
+struct SeriesColumn
+{
+    const float *data = nullptr;
+    const double *times = nullptr; // parallel to data
+    int count = 0;
+    int offset = 0;
+    uint64_t origin = 0; // rows appended to the connection before index 0
+    const MinMaxPyramid *pyramid = nullptr;
+    SpilledColumn spilled;
+
+    float operator[](size_t index) const
+    {
+        size_t spilledRows = spilled.size();
+        if (index < spilledRows)
+            return spilled[index];
+        size_t position = static_cast<size_t>(offset) + index - spilledRows;
+        if (position >= static_cast<size_t>(count))
+            position -= static_cast<size_t>(count);
+        return data[position];
+    }
+
+    double time(size_t index) const
+    {
+        size_t spilledRows = spilled.size();
+        if (index < spilledRows)
+            return spilled.time(index);
+        size_t position = static_cast<size_t>(offset) + index - spilledRows;
+        if (position >= static_cast<size_t>(count))
+            position -= static_cast<size_t>(count);
+        return times[position];
+    }
+
+    // Index of the first row stamped at or after t, or size() if none.
+    // Gallops back from the newest row before bisecting, so windows near
+    // the live end cost O(log distance from the end).
+    size_t lowerBound(double t) const
+    {
+        size_t n = size();
+        if (n == 0 || time(n - 1) < t)
+            return n;
+        size_t high = n - 1; // time(high) >= t
+        size_t low = 0;      // time(low) < t once found
+        for (size_t step = 1;; step *= 2)
+        {
+            if (high < step)
+            {
+                if (time(0) >= t)
+                    return 0;
+                break;
+            }
+            if (time(high - step) < t)
+            {
+                low = high - step;
+                break;
+            }
+            high -= step;
+        }
+        while (high - low > 1)
+        {
+            size_t middle = low + (high - low) / 2;
+            if (time(middle) < t)
+                low = middle;
+            else
+                high = middle;
+        }
+        return high;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t size() const { return spilled.size() + static_cast<size_t>(count); }
+
+    // Min and max of samples [first, last) in O(log n) over the ring and
+    // O(chunks) over spilled rows. Returns false when the range holds no
+    // number.
+    bool range(size_t first, size_t last, float &min, float &max) const
+    {
+        min = MinMaxPyramid::EMPTY_MIN;
+        max = MinMaxPyramid::EMPTY_MAX;
+        last = std::min(last, size());
+        if (first >= last)
+            return false;
+
+        size_t spilledRows = spilled.size();
+        if (first < spilledRows)
+        {
+            spilled.range(first, std::min(last, spilledRows), min, max);
+            first = spilledRows;
+        }
+        if (first < last)
+            ringRange(first - spilledRows, last - spilledRows, min, max);
+        return min <= max;
+    }
+
+    // Splits [first, last) into bucketCount equal buckets and writes the
+    // min and max of each, e.g. one bucket per horizontal pixel. Buckets
+    // with no number get min > max.
+    void buckets(size_t first, size_t last, size_t bucketCount, float *mins, float *maxs) const
+    {
+        last = std::min(last, size());
+        size_t length = last > first ? last - first : 0;
+        for (size_t b = 0; b < bucketCount; ++b)
+        {
+            size_t bucketFirst = first + length * b / bucketCount;
+            size_t bucketLast = first + length * (b + 1) / bucketCount;
+            range(bucketFirst, bucketLast, mins[b], maxs[b]);
+        }
+    }
+
+private:
+    // The logical range covers one physical run, or two when it wraps.
+    void ringRange(size_t first, size_t last, float &min, float &max) const
+    {
+        size_t ring = static_cast<size_t>(count);
+        size_t begin = static_cast<size_t>(offset) + first;
+        size_t end = static_cast<size_t>(offset) + last;
+        if (end <= ring)
+        {
+            physicalRange(begin, end, min, max);
+        }
+        else if (begin >= ring)
+        {
+            physicalRange(begin - ring, end - ring, min, max);
+        }
+        else
+        {
+            physicalRange(begin, ring, min, max);
+            physicalRange(0, end - ring, min, max);
+        }
+    }
+
+    void physicalRange(size_t first, size_t last, float &min, float &max) const
+    {
+        if (pyramid)
+        {
+            pyramid->query(data, first, last, min, max);
+            return;
+        }
+        for (size_t i = first; i < last; ++i)
+        {
+            min = data[i] < min ? data[i] : min;
+            max = data[i] > max ? data[i] : max;
+        }
+    }
+};
+
+// Columnar time-series store indexed by dense connection id.
+//
+// Each connection owns one block holding all of its columns back to back
+// (column c at [c * stride, c * stride + size)), plus a timestamp per row,
+// so appending a row writes columnCount floats into a single allocation and
+// drawing one metric walks a contiguous array. Every column of a connection
+// shares one ring position: once the ring is full, an append overwrites the
+// oldest row in O(1). Rings grow geometrically, so connections that only
+// send a few records stay small; they stop growing at `retention` rows, or
+// earlier once the oldest row is older than the retention window, so a
+// fast link keeps only the last few seconds and a slow one keeps its rows
+// until they age out. Each column keeps a MinMaxPyramid, updated on append,
+// for range min/max queries. With enableSpill(), overwritten rows move to
+// memory-mapped segment files in chunks of SPILL_CHUNK_ROWS instead of
+// being lost.
+class SeriesStore
+{
+public:
+    explicit SeriesStore(size_t columnCount = 1, size_t retention = 1000, double retentionSeconds = 0.0)
+        : columns(std::max<size_t>(columnCount, 1)), retention(std::max<size_t>(retention, 1)),
+          retentionSeconds(retentionSeconds) {}
+
+    // row holds columnCount() values; timestamp is in seconds. A timestamp
+    // older than the connection's previous one (or NaN) is clamped to it,
+    // so times never decrease along a column.
+    void append(size_t connectionId, const float *row, double timestamp)
+    {
+        if (connectionId >= blocks.size())
+            blocks.resize(connectionId + 1);
+        Block &block = blocks[connectionId];
+
+        if (block.appended > 0 && !(timestamp >= block.lastTime))
+            timestamp = block.lastTime;
+        else if (std::isnan(timestamp))
+            timestamp = 0.0;
+        block.lastTime = timestamp;
+
+        if (block.size == block.stride && block.size < retention &&
+            (block.size == 0 || retentionSeconds <= 0.0 || block.times[block.start] >= timestamp - retentionSeconds))
+            relayout(block, block.size, std::min(retention, std::max<size_t>(16, block.stride * 2)));
+
+        size_t position;
+        if (block.size < block.stride)
+        {
+            position = block.size++; // the ring only wraps once full
+        }
+        else
+        {
+            position = block.start;
+            block.start = block.start + 1 == block.size ? 0 : block.start + 1;
+            spill(block, position);
+        }
+
+        float *slot = block.samples.data() + position;
+        for (size_t c = 0; c < columns; ++c)
+        {
+            slot[c * block.stride] = row[c];
+            block.pyramids[c].update(block.samples.data() + c * block.stride, block.size, position);
+        }
+        block.times[position] = timestamp;
+        ++block.appended;
+        block.version = ++changes;
+        longest = std::max(longest, rows(block));
+    }
+
+    void append(size_t connectionId, float value, double timestamp) { append(connectionId, &value, timestamp); }
+
+    SeriesColumn column(size_t connectionId, size_t column) const
+    {
+        SeriesColumn view;
+        if (connectionId >= blocks.size())
+            return view;
+        const Block &block = blocks[connectionId];
+        view.data = block.samples.data() + column * block.stride;
+        view.times = block.times.data();
+        view.count = static_cast<int>(block.size);
+        view.offset = static_cast<int>(block.start);
+        view.origin = block.appended - rows(block);
+        view.pyramid = block.pyramids.empty() ? nullptr : &block.pyramids[column];
+        view.spilled.chunks = block.chunks.data();
+        view.spilled.chunkMins = block.chunkMins.data();
+        view.spilled.chunkMaxs = block.chunkMaxs.data();
+        view.spilled.chunkCount = block.chunks.size();
+        view.spilled.column = column;
+        view.spilled.columns = columns;
+        view.spilled.chunkTimes = block.chunkTimes.data();
+        view.spilled.staging = block.staging.data();
+        view.spilled.stagingTimes = block.stagingTimes.data();
+        view.spilled.stagingRows = block.stagingRows;
+        return view;
+    }
+
+    size_t columnCount() const { return columns; }
+    // Highest connection id appended to, plus one. Ids without data read as empty.
+    size_t connectionCount() const { return blocks.size(); }
+    size_t size(size_t connectionId) const { return connectionId < blocks.size() ? rows(blocks[connectionId]) : 0; }
+    // Readable rows in the fullest connection, spilled ones included.
+    size_t longestSeries() const { return longest; }
+
+    // Earliest and latest readable timestamp over all connections. Returns
+    // false when the store is empty.
+    bool timeSpan(double &first, double &last) const
+    {
+        bool any = false;
+        for (size_t id = 0; id < blocks.size(); ++id)
+        {
+            SeriesColumn view = column(id, 0);
+            if (view.empty())
+                continue;
+            first = any ? std::min(first, view.time(0)) : view.time(0);
+            last = any ? std::max(last, blocks[id].lastTime) : blocks[id].lastTime;
+            any = true;
+        }
+        return any;
+    }
+
+    // Moves rows pushed out of the in-memory ring to append-only segment
+    // files under directory instead of dropping them. They stay readable
+    // through column(), so the retention settings only bound memory.
+    // If a segment cannot be written, spilling stops and the store falls
+    // back to keeping just the ring.
+    void enableSpill(const std::filesystem::path &directory)
+    {
+        spillDirectory = directory;
+    }
+
+    bool spilling() const { return !spillDirectory.empty(); }
+
+    // Changes the most rows kept in memory per connection, keeping the newest.
+    void setRetention(size_t rows)
+    {
+        rows = std::max<size_t>(rows, 1);
+        if (rows == retention)
+            return;
+        retention = rows;
+        for (Block &block : blocks)
+        {
+            if (block.size <= rows)
+                continue;
+            for (size_t k = 0; k + rows < block.size; ++k)
+                spill(block, block.start + k < block.size ? block.start + k : block.start + k - block.size);
+            relayout(block, rows, rows);
+            block.version = ++changes;
+        }
+        updateLongest();
+    }
+
+    // Rings stop growing once their oldest row is this many seconds older
+    // than the newest; 0 leaves only the row limit. Takes effect as rows
+    // arrive.
+    void setRetentionSeconds(double seconds)
+    {
+        retentionSeconds = std::max(seconds, 0.0);
+    }
+
+    void clear()
+    {
+        blocks.clear();
+        segments.reset();
+        longest = 0;
+    }
+
+    // Makes this store equal to source, reusing existing allocations. A
+    // connection that did not change is skipped, and one that only gained
+    // rows copies just those rows and the spill chunks sealed meanwhile, so
+    // a sync costs what was appended since the last one rather than what is
+    // retained. Only a ring that was reallocated, or lapped, is copied whole.
+    void syncFrom(const SeriesStore &source)
+    {
+        columns = source.columns;
+        retention = source.retention;
+        retentionSeconds = source.retentionSeconds;
+        longest = source.longest;
+        changes = source.changes;
+        spillDirectory = source.spillDirectory;
+        segments = source.segments; // sealed chunks are immutable, so they are shared
+        blocks.resize(source.blocks.size());
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            if (blocks[i].version != source.blocks[i].version && !syncRows(blocks[i], source.blocks[i]))
+                blocks[i] = source.blocks[i];
+        }
+    }
+
+private:
+    struct Block
+    {
+        std::vector<float> samples;          // columns * stride
+        std::vector<double> times;           // stride, parallel to each column
+        std::vector<MinMaxPyramid> pyramids; // one per column
+        std::vector<const float *> chunks;   // sealed spill chunks, oldest first
+        std::vector<const double *> chunkTimes;
+        std::vector<float> chunkMins;        // chunks * columns
+        std::vector<float> chunkMaxs;
+        std::vector<float> staging;          // columns * SPILL_CHUNK_ROWS, the chunk being filled
+        std::vector<double> stagingTimes;    // SPILL_CHUNK_ROWS
+        size_t stagingRows = 0;
+        size_t stride = 0;                   // allocated rows per column
+        size_t size = 0;                     // rows held
+        size_t start = 0;                    // oldest row once full, 0 before
+        double lastTime = 0.0;               // timestamp of the newest row
+        uint64_t appended = 0;               // rows ever appended, including dropped ones
+        uint64_t version = 0;                // value of `changes` at the last write
+        uint64_t layout = 0;                 // value of `changes` when the ring or spill tier was last rebuilt
+    };
+
+    // Brings block, an earlier copy of from, up to date by copying the rows
+    // appended since. False when that is not possible: the ring was rebuilt
+    // or has been lapped, or block is not an earlier copy.
+    bool syncRows(Block &block, const Block &from) const
+    {
+        if (block.layout != from.layout || block.appended > from.appended ||
+            from.appended - block.appended > from.size || block.chunks.size() > from.chunks.size() ||
+            (block.chunks.size() == from.chunks.size() && block.stagingRows > from.stagingRows))
+            return false;
+
+        // The new rows are the newest `added` of the ring. Each touched
+        // pyramid leaf is rescanned once, after its last new row.
+        size_t added = static_cast<size_t>(from.appended - block.appended);
+        size_t stride = from.stride;
+        for (size_t k = from.size - added; k < from.size; ++k)
+        {
+            size_t position = from.start + k < from.size ? from.start + k : from.start + k - from.size;
+            for (size_t c = 0; c < columns; ++c)
+                block.samples[c * stride + position] = from.samples[c * stride + position];
+            block.times[position] = from.times[position];
+            size_t next = position + 1 == from.size ? 0 : position + 1;
+            if (k + 1 == from.size || next / MinMaxPyramid::LEAF != position / MinMaxPyramid::LEAF)
+            {
+                for (size_t c = 0; c < columns; ++c)
+                    block.pyramids[c].update(block.samples.data() + c * stride, from.size, position);
+            }
+        }
+
+        // Sealed chunks are shared; the staging chunk restarts after a seal.
+        size_t stagingFirst = block.stagingRows;
+        if (block.chunks.size() < from.chunks.size())
+        {
+            block.chunks.insert(block.chunks.end(), from.chunks.begin() + block.chunks.size(), from.chunks.end());
+            block.chunkTimes.insert(block.chunkTimes.end(), from.chunkTimes.begin() + block.chunkTimes.size(),
+                                    from.chunkTimes.end());
+            block.chunkMins.insert(block.chunkMins.end(), from.chunkMins.begin() + block.chunkMins.size(),
+                                   from.chunkMins.end());
+            block.chunkMaxs.insert(block.chunkMaxs.end(), from.chunkMaxs.begin() + block.chunkMaxs.size(),
+                                   from.chunkMaxs.end());
+            stagingFirst = 0;
+        }
+        if (block.staging.size() != from.staging.size())
+        {
+            block.staging.resize(from.staging.size());
+            block.stagingTimes.resize(from.stagingTimes.size());
+        }
+        if (from.stagingRows > stagingFirst)
+        {
+            for (size_t c = 0; c < columns; ++c)
+                std::copy(from.staging.begin() + c * SPILL_CHUNK_ROWS + stagingFirst,
+                          from.staging.begin() + c * SPILL_CHUNK_ROWS + from.stagingRows,
+                          block.staging.begin() + c * SPILL_CHUNK_ROWS + stagingFirst);
+            std::copy(from.stagingTimes.begin() + stagingFirst, from.stagingTimes.begin() + from.stagingRows,
+                      block.stagingTimes.begin() + stagingFirst);
+        }
+        block.stagingRows = from.stagingRows;
+
+        block.size = from.size;
+        block.start = from.start;
+        block.lastTime = from.lastTime;
+        block.appended = from.appended;
+        block.version = from.version;
+        return true;
+    }
+
+    // Moves the newest `keep` rows, oldest first, into a ring of `stride`
+    // rows that has not wrapped.
+    void relayout(Block &block, size_t keep, size_t stride)
+    {
+        std::vector<float> samples(columns * stride);
+        std::vector<double> times(stride);
+        for (size_t k = 0; k < keep; ++k)
+        {
+            size_t position = block.start + block.size - keep + k;
+            if (position >= block.size)
+                position -= block.size;
+            for (size_t c = 0; c < columns; ++c)
+                samples[c * stride + k] = block.samples[c * block.stride + position];
+            times[k] = block.times[position];
+        }
+        block.samples.swap(samples);
+        block.times.swap(times);
+        block.stride = stride;
+        block.size = keep;
+        block.start = 0;
+        block.layout = ++changes;
+        rebuildPyramids(block);
+    }
+
+    static size_t rows(const Block &block)
+    {
+        return block.chunks.size() * SPILL_CHUNK_ROWS + block.stagingRows + block.size;
+    }
+
+    void updateLongest()
+    {
+        longest = 0;
+        for (const Block &block : blocks)
+            longest = std::max(longest, rows(block));
+    }
+
+    // Copies ring row `position`, about to be dropped, to the staging chunk
+    // and seals the chunk into a segment once it is full.
+    void spill(Block &block, size_t position)
+    {
+        if (!spilling())
+            return;
+        if (block.staging.empty())
+        {
+            block.staging.resize(columns * SPILL_CHUNK_ROWS);
+            block.stagingTimes.resize(SPILL_CHUNK_ROWS);
+        }
+        for (size_t c = 0; c < columns; ++c)
+            block.staging[c * SPILL_CHUNK_ROWS + block.stagingRows] = block.samples[c * block.stride + position];
+        block.stagingTimes[block.stagingRows] = block.times[position];
+        if (++block.stagingRows < SPILL_CHUNK_ROWS)
+            return;
+
+        if (!segments)
+            segments = std::make_shared<SegmentStore>(spillDirectory);
+        const float *chunk = segments->append(block.staging.data(), block.staging.size());
+        const double *chunkTimes = chunk ? segments->append(block.stagingTimes.data(), SPILL_CHUNK_ROWS) : nullptr;
+        if (!chunkTimes)
+        {
+            std::cerr << "Spilling series to " << spillDirectory.string()
+                      << " failed; keeping only the in-memory window" << std::endl;
+            disableSpill();
+            return;
+        }
+        block.chunks.push_back(chunk);
+        block.chunkTimes.push_back(chunkTimes);
+        for (size_t c = 0; c < columns; ++c)
+        {
+            float min = MinMaxPyramid::EMPTY_MIN;
+            float max = MinMaxPyramid::EMPTY_MAX;
+            for (size_t row = 0; row < SPILL_CHUNK_ROWS; ++row)
+            {
+                float value = block.staging[c * SPILL_CHUNK_ROWS + row];
+                min = value < min ? value : min;
+                max = value > max ? value : max;
+            }
+            block.chunkMins.push_back(min);
+            block.chunkMaxs.push_back(max);
+        }
+        block.stagingRows = 0;
+    }
+
+    void disableSpill()
+    {
+        spillDirectory.clear();
+        segments.reset();
+        for (Block &block : blocks)
+        {
+            block.chunks.clear();
+            block.chunkTimes.clear();
+            block.chunkMins.clear();
+            block.chunkMaxs.clear();
+            block.staging.clear();
+            block.stagingTimes.clear();
+            block.stagingRows = 0;
+            block.version = ++changes;
+            block.layout = block.version;
+        }
+        updateLongest();
+    }
+
+    void rebuildPyramids(Block &block)
+    {
+        block.pyramids.resize(columns);
+        for (size_t c = 0; c < columns; ++c)
+            block.pyramids[c].rebuild(block.samples.data() + c * block.stride, block.size, block.stride);
+    }
+
+    std::vector<Block> blocks;
+    size_t columns;
+    size_t retention;
+    double retentionSeconds;
+    size_t longest = 0;
+    std::filesystem::path spillDirectory; // empty: rows leaving the ring are dropped
+    std::shared_ptr<SegmentStore> segments;
+    uint64_t changes = 0; // never reset, so versions stay unique across clear()
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+// Maps the handful of WinSock names used throughout main.cpp onto their
+// BSD socket equivalents so the same code compiles on Linux, plus the two
+// calls non-blocking sockets need that the APIs spell differently.
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+
+inline bool setSocketNonBlocking(SOCKET s)
+{
+    u_long mode = 1;
+    return ioctlsocket(s, FIONBIO, &mode) == 0;
+}
+inline bool socketWouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using SOCKET = int;
+using SOCKADDR = sockaddr;
+
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+#define SD_BOTH SHUT_RDWR
+#define WSAEADDRINUSE EADDRINUSE
+
+inline int closesocket(SOCKET s) { return ::close(s); }
+inline int WSAGetLastError() { return errno; }
+
+inline bool setSocketNonBlocking(SOCKET s)
+{
+    int flags = ::fcntl(s, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+inline bool socketWouldBlock() { return errno == EWOULDBLOCK || errno == EAGAIN; }
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// Bounded lock-free single-producer / single-consumer ring.
+//
+// Both ingest backends receive on one thread, so a single producer is all
+// the data path needs. push() never blocks: records that do not fit are
+// counted as dropped and discarded. Batch operations publish with a single
+// release store, so a burst of N records costs one cross-core handoff.
+template <typename T>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing holds trivially copyable records");
+
+public:
+    explicit SpscRing(size_t minCapacity)
+    {
+        size_t capacity = 2;
+        while (capacity < minCapacity)
+            capacity <<= 1;
+        mask = capacity - 1;
+        slots.reset(new T[capacity]);
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer side. Returns how many of the n items were enqueued.
+    size_t push(const T *items, size_t n)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t free = capacity() - (tail - cachedHead);
+        if (free < n)
+        {
+            cachedHead = head_.load(std::memory_order_acquire);
+            free = capacity() - (tail - cachedHead);
+        }
+
+        size_t count = std::min(n, free);
+        for (size_t i = 0; i < count; ++i)
+        {
+            slots[(tail + i) & mask] = items[i];
+        }
+        tail_.store(tail + count, std::memory_order_release);
+
+        // cachedHead is only refreshed when the ring looks full, so it can
+        // lag far behind; the peak needs the consumer's current position.
+        size_t occupancy = tail + count - head_.load(std::memory_order_relaxed);
+        if (occupancy > highWater.load(std::memory_order_relaxed))
+            highWater.store(occupancy, std::memory_order_relaxed);
+        if (count < n)
+            dropped_.fetch_add(n - count, std::memory_order_relaxed);
+        return count;
+    }
+
+    bool push(const T &item) { return push(&item, 1) == 1; }
+
+    // Consumer side. Returns how many items were written to out.
+    size_t pop(T *out, size_t maxItems)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t available = cachedTail - head;
+        if (available < maxItems)
+        {
+            cachedTail = tail_.load(std::memory_order_acquire);
+            available = cachedTail - head;
+        }
+
+        size_t count = std::min(maxItems, available);
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = slots[(head + i) & mask];
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Discards everything currently queued.
+    void clear()
+    {
+        cachedTail = tail_.load(std::memory_order_acquire);
+        head_.store(cachedTail, std::memory_order_release);
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t size() const
+    {
+        // Read head first: tail only grows, so it can never be behind it.
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+    bool empty() const { return size() == 0; }
+    size_t highWaterMark() const { return highWater.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::unique_ptr<T[]> slots;
+    size_t mask = 0;
+
+    // Producer-owned.
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cachedHead = 0;
+    std::atomic<size_t> highWater{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    // Consumer-owned.
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cachedTail = 0;
+};
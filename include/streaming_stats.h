@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Running summary of one metric on one connection, updated in O(1) per
+// sample: Welford mean and variance, an exponentially weighted moving
+// average, and the extremes. NaN samples are skipped.
+struct RunningStats
+{
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0; // sum of squared deviations from the mean
+    double ewma = 0.0;
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+
+    void add(float value, double ewmaAlpha)
+    {
+        if (std::isnan(value))
+            return;
+        ++count;
+        double delta = value - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (value - mean);
+        ewma = count == 1 ? value : ewma + ewmaAlpha * (value - ewma);
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    // Sample variance; 0 until there are two samples.
+    double variance() const { return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+};
+
+// RunningStats for every metric of every connection, indexed by the same
+// dense connection ids as SeriesStore, plus a per-connection record count
+// and arrival rate over a tumbling time window.
+class StatsStore
+{
+public:
+    explicit StatsStore(size_t metricCount = 1, double ewmaAlpha = 0.1, double rateWindowSeconds = 1.0)
+        : metrics(std::max<size_t>(metricCount, 1)), alpha(ewmaAlpha), window(rateWindowSeconds) {}
+
+    // row holds metricCount() values; timestamp is in seconds.
+    void update(size_t connectionId, const float *row, double timestamp)
+    {
+        if (connectionId >= connections.size())
+        {
+            connections.resize(connectionId + 1);
+            values.resize((connectionId + 1) * metrics);
+        }
+        Connection &connection = connections[connectionId];
+
+        ++connection.records;
+        if (connection.records == 1 || timestamp < connection.windowStart)
+        {
+            connection.windowStart = timestamp;
+        }
+        else if (timestamp >= connection.windowStart + window)
+        {
+            // A gap longer than one window means nothing arrived in the
+            // window just before this record.
+            bool contiguous = timestamp < connection.windowStart + 2 * window;
+            connection.rate = contiguous ? connection.windowCount / window : 0.0;
+            connection.windowStart = contiguous ? connection.windowStart + window : timestamp;
+            connection.windowCount = 0;
+        }
+        ++connection.windowCount;
+
+        RunningStats *stats = values.data() + connectionId * metrics;
+        for (size_t m = 0; m < metrics; ++m)
+            stats[m].add(row[m], alpha);
+        connection.version = ++changes;
+    }
+
+    // Stats for a connection id that has not been seen read as empty.
+    const RunningStats &metric(size_t connectionId, size_t metric) const
+    {
+        static const RunningStats empty;
+        return connectionId < connections.size() ? values[connectionId * metrics + metric] : empty;
+    }
+
+    uint64_t records(size_t connectionId) const
+    {
+        return connectionId < connections.size() ? connections[connectionId].records : 0;
+    }
+
+    // Records per second over the last complete window.
+    double rate(size_t connectionId) const
+    {
+        return connectionId < connections.size() ? connections[connectionId].rate : 0.0;
+    }
+
+    size_t metricCount() const { return metrics; }
+    size_t connectionCount() const { return connections.size(); }
+    double ewmaAlpha() const { return alpha; }
+    double rateWindow() const { return window; }
+
+    void clear()
+    {
+        connections.clear();
+        values.clear();
+    }
+
+    // Makes this store equal to source, copying only connections updated
+    // since the last sync.
+    void syncFrom(const StatsStore &source)
+    {
+        metrics = source.metrics;
+        alpha = source.alpha;
+        window = source.window;
+        changes = source.changes;
+        connections.resize(source.connections.size());
+        values.resize(source.values.size());
+        for (size_t id = 0; id < connections.size(); ++id)
+        {
+            if (connections[id].version == source.connections[id].version)
+                continue;
+            connections[id] = source.connections[id];
+            std::copy_n(source.values.data() + id * metrics, metrics, values.data() + id * metrics);
+        }
+    }
+
+private:
+    struct Connection
+    {
+        uint64_t version = 0; // value of `changes` at the last update
+        uint64_t records = 0;
+        double windowStart = 0.0;
+        uint64_t windowCount = 0;
+        double rate = 0.0;
+    };
+
+    std::vector<Connection> connections;
+    std::vector<RunningStats> values; // connections * metrics
+    size_t metrics;
+    double alpha;
+    double window;
+    uint64_t changes = 0; // never reset, so versions stay unique across clear()
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "decision_tree.h"
+
+// Forest of decision trees that scores records a batch at a time.
+//
+// All trees share one node array in the exported breadth-first layout, with
+// every leaf rewritten as a node that loops back to itself. A block of
+// records then walks each tree in lockstep for exactly that tree's depth:
+// every step is the same load, compare and select for every record, with no
+// branch on whether a walk has already ended, so the independent walks
+// overlap in the pipeline while the tree stays in L1 for the whole block.
+//
+// Each leaf names a row of `width` doubles, and sum() adds up, per record
+// and in tree order, the rows it reaches. The caller turns the sums into a
+// prediction the way sklearn does: averaged class probabilities for
+// RandomForestClassifier, averaged path lengths for IsolationForest.
+// Batches of at least PARALLEL_MIN_ROWS records are split across cores.
+//
+// export_model.py writes the arrays in exactly this layout, so the ensemble
+// works on them in place inside the mapped model file.
+class TreeEnsemble
+{
+public:
+    static constexpr size_t BLOCK = 64;
+    static constexpr size_t PARALLEL_MIN_ROWS = 1024;
+
+    struct Tree
+    {
+        uint32_t root;
+        uint32_t depth; // steps from the root to the deepest leaf
+    };
+
+    // Points the ensemble at its arrays, which must outlive it: the nodes
+    // of every tree back to back, a value row index per node (read at
+    // leaves), each tree's root and depth, and the rows of rowWidth values.
+    // Checks that every walk stays inside its own tree and ends on a leaf
+    // after exactly the tree's depth; false if anything is out of place.
+    bool assign(const TreeNode *nodeData, size_t nodeCount, const uint32_t *leafRowData, const Tree *treeData,
+                size_t treeCount, const double *valueData, size_t valueCount, uint32_t featureCount,
+                uint32_t rowWidth)
+    {
+        if (treeCount == 0 || nodeCount == 0 || nodeCount >= TREE_FEATURE_MASK || rowWidth == 0 ||
+            valueCount % rowWidth != 0 || treeData[0].root != 0)
+            return false;
+        size_t rowCount = valueCount / rowWidth;
+
+        std::vector<uint32_t> depth(nodeCount, 0);
+        for (size_t t = 0; t < treeCount; ++t)
+        {
+            size_t root = treeData[t].root;
+            size_t end = t + 1 < treeCount ? treeData[t + 1].root : nodeCount;
+            if (root >= end || end > nodeCount)
+                return false;
+            uint32_t maxDepth = 0;
+            for (size_t i = root; i < end; ++i)
+            {
+                const TreeNode &node = nodeData[i];
+                // A walk cut short by a bad depth ends on an internal node,
+                // so every row index is checked, not only the leaves'.
+                if (leafRowData[i] >= rowCount)
+                    return false;
+                if (node.left == i)
+                {
+                    // Every value is <= +inf and NaN goes left: the walk stays put.
+                    if (node.threshold != std::numeric_limits<float>::infinity() ||
+                        node.feature != TREE_MISSING_LEFT || node.right != i + 1)
+                        return false;
+                    maxDepth = std::max(maxDepth, depth[i]);
+                }
+                else
+                {
+                    if (node.left <= i || node.left + 1 >= end || node.right != node.left + 1 ||
+                        (node.feature & TREE_FEATURE_MASK) >= featureCount)
+                        return false;
+                    depth[node.left] = depth[node.right] = depth[i] + 1;
+                }
+            }
+            if (treeData[t].depth != maxDepth)
+                return false;
+        }
+
+        nodes = nodeData;
+        leafRows = leafRowData;
+        trees = treeData;
+        treeTotal = treeCount;
+        nodeTotal = nodeCount;
+        values = valueData;
+        features = featureCount;
+        width = rowWidth;
+        return true;
+    }
+
+    // Sums, for each of count rows of featureCount floats, the leaf rows it
+    // reaches: width doubles per row in out.
+    void sum(const float *rows, size_t count, double *out) const
+    {
+        size_t threads = 1;
+        if (count >= PARALLEL_MIN_ROWS)
+            threads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count / (PARALLEL_MIN_ROWS / 2));
+        if (threads <= 1)
+        {
+            sumRange(rows, count, out);
+            return;
+        }
+
+        size_t chunk = ((count + threads - 1) / threads + BLOCK - 1) / BLOCK * BLOCK;
+        std::vector<std::thread> workers;
+        for (size_t first = chunk; first < count; first += chunk)
+        {
+            size_t n = std::min(chunk, count - first);
+            workers.emplace_back([this, rows, out, first, n]()
+                                 { sumRange(rows + first * features, n, out + first * width); });
+        }
+        sumRange(rows, std::min(chunk, count), out);
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    size_t treeCount() const { return treeTotal; }
+    size_t nodeCount() const { return nodeTotal; }
+    uint32_t rowWidth() const { return width; }
+
+private:
+    // Advances the walks of n records `depth` steps down from at[]. Right
+    // children follow their left sibling, so a step is one compare and add;
+    // the NaN check is compiled in only for blocks that need it.
+    template <bool CheckNaN>
+    void walk(uint32_t depth, const float *block, uint32_t *at, size_t n) const
+    {
+        const TreeNode *tree = nodes;
+        for (uint32_t step = 0; step < depth; ++step)
+        {
+            for (size_t r = 0; r < n; ++r)
+            {
+                const TreeNode &node = tree[at[r]];
+                float value = block[r * features + (node.feature & TREE_FEATURE_MASK)];
+                // Not "value > threshold": a NaN threshold must send every value right.
+                uint32_t right = !(value <= node.threshold);
+                if (CheckNaN)
+                    right &= !((value != value) & ((node.feature & TREE_MISSING_LEFT) != 0));
+                at[r] = node.left + right;
+            }
+        }
+    }
+
+    void sumRange(const float *rows, size_t count, double *out) const
+    {
+        uint32_t at[BLOCK];
+        for (size_t first = 0; first < count; first += BLOCK)
+        {
+            size_t n = std::min(BLOCK, count - first);
+            const float *block = rows + first * features;
+            double *sums = out + first * width;
+            std::fill(sums, sums + n * width, 0.0);
+            bool hasNaN = false;
+            for (size_t i = 0; i < n * features; ++i)
+                hasNaN |= block[i] != block[i];
+
+            for (size_t t = 0; t < treeTotal; ++t)
+            {
+                const Tree &tree = trees[t];
+                for (size_t r = 0; r < n; ++r)
+                    at[r] = tree.root;
+                if (hasNaN)
+                    walk<true>(tree.depth, block, at, n);
+                else
+                    walk<false>(tree.depth, block, at, n);
+                for (size_t r = 0; r < n; ++r)
+                {
+                    const double *leaf = &values[static_cast<size_t>(leafRows[at[r]]) * width];
+                    double *sum = &sums[r * width];
+                    for (uint32_t c = 0; c < width; ++c)
+                        sum[c] += leaf[c];
+                }
+            }
+        }
+    }
+
+    const TreeNode *nodes = nullptr;    // every tree breadth-first, leaves as self loops
+    const uint32_t *leafRows = nullptr; // per node: value row when it is a leaf
+    const Tree *trees = nullptr;
+    const double *values = nullptr; // width values per row
+    size_t treeTotal = 0;
+    size_t nodeTotal = 0;
+    uint32_t features = 0;
+    uint32_t width = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-writer / single-reader snapshot publication.
+//
+// Three instances of T rotate between the writer (back), the reader (front)
+// and a hand-off slot (middle). publish() swaps back into the middle and
+// read() swaps a freshly published middle into the front, each with a single
+// atomic exchange, so neither side ever waits for the other and the writer
+// never touches the buffer the reader is drawing from. Buffers are reused,
+// so a T with vectors or maps keeps its capacity from one publish to the
+// next.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Writer side. The buffer to fill before the next publish(); it holds
+    // whatever was published two rounds ago, not the latest snapshot.
+    T &writeBuffer() { return buffers[back]; }
+
+    // Writer side. Makes writeBuffer() the latest snapshot.
+    void publish()
+    {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // Reader side. Returns the most recently published snapshot. The
+    // reference stays valid and unchanged until the next call to read().
+    const T &read()
+    {
+        if (middle.load(std::memory_order_relaxed) & FRESH)
+        {
+            uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & INDEX_MASK;
+        }
+        return buffers[front];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    T buffers[3];
+    uint8_t back = 0;                // writer-owned
+    std::atomic<uint8_t> middle{1};  // shared, FRESH when not yet read
+    uint8_t front = 2;               // reader-owned
+};
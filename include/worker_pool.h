@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads that run one job at a time alongside the
+// caller. A job is count tasks, task(0) .. task(count - 1), taken in order
+// by whichever thread is free; run() returns once every task has finished,
+// so the threads are started once and reused for every job instead of
+// being created per call.
+//
+// One caller at a time. Tasks must not call run() on the same pool.
+class WorkerPool
+{
+public:
+    explicit WorkerPool(size_t threadCount)
+    {
+        workers.reserve(threadCount);
+        for (size_t t = 0; t < threadCount; ++t)
+            workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    size_t threadCount() const { return workers.size(); }
+
+    // Runs task(i) for every i below count, on the calling thread and the
+    // workers, and waits for all of them.
+    template <typename Task>
+    void run(size_t count, Task &&task)
+    {
+        if (workers.empty() || count <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+        using Callable = std::remove_reference_t<Task>;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // A worker that woke after the last job ended still holds it;
+            // it must be out before the task counter is reset.
+            finished.wait(lock, [this]() { return active == 0; });
+            invoke = [](void *context, size_t i) { (*static_cast<Callable *>(context))(i); };
+            context = const_cast<void *>(static_cast<const void *>(&task));
+            taskCount = count;
+            next.store(0, std::memory_order_relaxed);
+            unfinished = count;
+            ++generation;
+        }
+        wake.notify_all();
+        size_t done = work(invoke, context, count);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        unfinished -= done;
+        // Workers still inside the job hold its task; wait them out too.
+        finished.wait(lock, [this]() { return unfinished == 0 && active == 0; });
+    }
+
+private:
+    size_t work(void (*job)(void *, size_t), void *jobContext, size_t count)
+    {
+        size_t done = 0;
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next.fetch_add(1, std::memory_order_relaxed))
+        {
+            job(jobContext, i);
+            ++done;
+        }
+        return done;
+    }
+
+    void workerLoop()
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            void (*job)(void *, size_t) = invoke;
+            void *jobContext = context;
+            size_t count = taskCount;
+            ++active;
+            lock.unlock();
+            size_t done = work(job, jobContext, count);
+            lock.lock();
+            unfinished -= done;
+            --active;
+            if (unfinished == 0 && active == 0)
+                finished.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;     // a job was posted, or the pool is stopping
+    std::condition_variable finished; // the last task of a job returned
+    // The current job, written under mutex.
+    void (*invoke)(void *, size_t) = nullptr;
+    void *context = nullptr;
+    size_t taskCount = 0;
+    std::atomic<size_t> next{0}; // next task index to hand out
+    size_t unfinished = 0;       // tasks not yet returned
+    size_t active = 0;           // workers inside the current job
+    uint64_t generation = 0;
+    bool stopping = false;
+};
@@ -15,8 +15,7 @@
 #include <queue>
 #include <Python.h>
 #include <cstdlib>
-#include <WinSock2.h>
-#include <WS2tcpip.h>
+#include "socket_compat.h"
 #include <limits>
 #ifndef IMPLOT_INTERNAL_H
 #define IMPLOT_INTERNAL_H
@@ -29,13 +28,36 @@
 #include <thread>
 #include <sqlite3.h>
 #include <filesystem>
+#include <memory>
+#ifdef _WIN32
 #include <Windows.h>
 #include <commdlg.h>
+#endif
 #include <ctime>
 #include <iomanip>
 #include <sstream>
+#include "json_record_parser.h"
+#include "record.h"
+#include "record_stream.h"
+#include "series_store.h"
+#include "downsample.h"
+#include "streaming_stats.h"
+#include "connection_index.h"
+#include "feature_schema.h"
+#include "native_model.h"
+#include "pipeline_metrics.h"
+#include "prediction_client.h"
+#include "prediction_stats.h"
+#include "spsc_ring.h"
+#include "triple_buffer.h"
+#include "worker_pool.h"
+#ifdef SG_INGEST_EPOLL
+#include "epoll_ingest_server.h"
+#endif
 
+#ifdef _WIN32
 #pragma comment(lib, "Ws2_32.lib")
+#endif
 using json = nlohmann::json;
 #include <random>
 
@@ -63,14 +85,6 @@ enum class AttackType
     MITM_SCADA
 };
 
-struct AttackInfo
-{
-    bool none;
-    bool ddos;
-    bool synflood;
-    bool mitm;
-};
-
 enum class TrafficType
 {
     NORMAL,
@@ -83,40 +97,74 @@ TrafficType currentTrafficType = TrafficType::NORMAL;
 
 const char *attackLabels[] = {"None", "DDoS", "SYN Flood", "MITM"};
 
-struct PlotData
+// In-memory retention per connection per plot: the last seriesRetentionSeconds
+// of records, capped at seriesRetention points. Set from the UI, applied by
+// the processing thread at its next batch. Older points are spilled to
+// segment files under seriesSpillDirectory, when set, rather than dropped.
+std::atomic<int> seriesRetention(10000);
+std::atomic<float> seriesRetentionSeconds(60.0f);
+std::filesystem::path seriesSpillDirectory;
+
+// Seconds across one plot width (the zoom level). UI thread only.
+float visibleSeconds = 10.0f;
+bool showWholeCapture = false; // fit the entire history into one plot width
+
+// A model evaluated in process from its export_model.py file, with the
+// statistics prediction_script.py would otherwise keep for it. The stats are
+// touched only by the processing thread while a run is active; the model is
+// replaced under it by nativeModelWatcherThread, so it is only read and
+// written through std::atomic_load / std::atomic_store.
+struct NativeDetector
 {
-    // std::map<std::pair<int, int>, std::vector<float>> time;
-    std::map<std::pair<int, int>, std::vector<float>> values;
+    std::shared_ptr<const NativeModel> model;
+    PredictionStats stats;
+    std::filesystem::path pklPath;
+    std::filesystem::path nativePath;
+    // Last seen modification times of both files; model watcher only.
+    std::filesystem::file_time_type pklWriteTime;
+    std::filesystem::file_time_type nativeWriteTime;
 };
+
+// score_samples() cut-off for isolation forests run in process. Set from the
+// UI, picked up by the processing thread at its next batch.
+std::atomic<double> anomalyThreshold(DEFAULT_ANOMALY_THRESHOLD);
+
+// Prediction requests a model connection keeps on the wire at once.
+constexpr int DEFAULT_IN_FLIGHT_WINDOW = 32;
+constexpr int MAX_IN_FLIGHT_WINDOW = 1024;
+// How long a prediction script may leave a request unanswered before its
+// connection is treated as stalled and skipped.
+constexpr int DEFAULT_PREDICTION_TIMEOUT_MS = 2000;
+constexpr int MIN_PREDICTION_TIMEOUT_MS = 50;
+constexpr int MAX_PREDICTION_TIMEOUT_MS = 60000;
+// Records per prediction request, and how long the first may wait for the
+// rest: bigger batches cost the script far less per record, longer delays
+// let them fill when the feed is slow, at the price of latency.
+constexpr int DEFAULT_PREDICTION_BATCH = 32;
+constexpr int MAX_PREDICTION_BATCH = 4096;
+constexpr int DEFAULT_BATCH_DELAY_MS = 5;
+constexpr int MAX_BATCH_DELAY_MS = 1000;
+
 struct ModelInfo
 {
     std::string name;
     std::string path;
     bool selected;
+    bool native = false; // run in process instead of through prediction_script.py
+    std::shared_ptr<NativeDetector> detector; // loaded when a native run starts
+    int inFlightWindow = DEFAULT_IN_FLIGHT_WINDOW;
+    int predictionTimeoutMs = DEFAULT_PREDICTION_TIMEOUT_MS;
+    int predictionBatch = DEFAULT_PREDICTION_BATCH;
+    int batchDelayMs = DEFAULT_BATCH_DELAY_MS;
+    std::shared_ptr<PredictionClient> client; // set while connected to prediction_script.py
     SOCKET socket;
     int port;
     ImVec4 color;
-    std::vector<PlotData> plotData;
     std::map<AttackType, float> attackAccuracy;
-    ModelInfo() : plotData(1) {} // Initialize with one PlotData for predictions
 };
-std::vector<std::string> metricLabels = {
-    "Packets Dropped",
-    "Average Queue Size",
-    "System Occupancy",
-    "Service Rate",
-    "Transmission Delay",
-    "Round Trip Time (RTT)",
-    "Arrival Rate",
-    "Attack Type",
-    "Packet Size",
-    "IAT",
-    "Acknowledgement Size",
-    "Packet Count (PC)"};
-
-// Update the plotDataArray size initialization
-std::vector<PlotData> plotDataArray(metricLabels.size());
-std::vector<std::mutex> plotDataMutexes(metricLabels.size());
+// Plot titles in display order, generated from RECORD_SCHEMA.
+std::vector<std::string> metricLabels(PLOT_LABELS.begin(), PLOT_LABELS.end());
+
 std::vector<bool> plotVisibility(metricLabels.size(), true);
 
 std::random_device rd;
@@ -125,24 +173,41 @@ std::uniform_int_distribution<> portDist(12348, 65535);
 
 std::vector<ModelInfo> availableModels;
 std::mutex modelsMutex;
-struct pair_hash
+// Scores the native models of a batch side by side: one thread for each
+// beyond the first, started when a run begins. Guarded by modelsMutex.
+std::shared_ptr<WorkerPool> nativeWorkers;
+// Each (FB, TB) pair is interned once into a dense connection id, which
+// indexes every series store. connectionLabels maps the id back for legends.
+ConnectionIndex connectionIndex;
+std::vector<std::string> connectionLabels;
+uint64_t connectionEpoch = 0; // bumped whenever ids are reassigned
+
+SeriesStore metricSeries(PLOT_METRIC_COUNT);  // one column per metric plot, in plot order
+StatsStore metricStats(PLOT_METRIC_COUNT);    // running stats over the same columns
+std::vector<SeriesStore> predictionSeries;    // one per availableModels entry
+
+// Copy of the series for the renderer. The processing thread owns
+// metricSeries, metricStats, predictionSeries and the connection ids; the
+// render loop only ever draws from the most recently published snapshot.
+struct PlotSnapshot
 {
-    template <class T1, class T2>
-    std::size_t operator()(const std::pair<T1, T2> &p) const
-    {
-        auto h1 = std::hash<T1>{}(p.first);
-        auto h2 = std::hash<T2>{}(p.second);
-        return h1 ^ h2;
-    }
+    SeriesStore metrics{PLOT_METRIC_COUNT};
+    StatsStore stats{PLOT_METRIC_COUNT};
+    std::vector<SeriesStore> predictions;
+    std::vector<std::string> connectionLabels;
+    uint64_t connectionEpoch = 0;
 };
 
-std::unordered_map<std::pair<int, int>, int, pair_hash> fbTbCombinations;
+TripleBuffer<PlotSnapshot> plotSnapshots; // writer side serialized by queueMutex
+std::atomic<uint64_t> recordsProcessed(0);
 const int MAX_COMBINATIONS = 10; 
 const int MAX_LINES = 10;        
-std::queue<std::vector<float>> dataQueue;
+const size_t DATA_QUEUE_CAPACITY = 1 << 16;
+SpscRing<Record> dataQueue(DATA_QUEUE_CAPACITY);
 std::vector<json> modelStats;
-std::mutex queueMutex;
-bool simulationRunning = false;
+std::mutex queueMutex; // consumer side of dataQueue and the live series; ingest never takes it
+std::atomic<uint64_t> framingErrorCount(0);
+std::atomic<bool> simulationRunning(false);
 bool simulationEnded = false;
 bool includeDOS = true;       // Global variable to control DOS inclusion
 int totalSimulationTime = 20; // Default total simulation time in seconds
@@ -152,6 +217,9 @@ std::atomic<bool> receiverRunning(true);
 SOCKET predictionSocket = INVALID_SOCKET;
 std::atomic<bool> shouldExit(false);
 SOCKET listenSocket = INVALID_SOCKET;
+#ifdef SG_INGEST_EPOLL
+EpollIngestServer ingestServer;
+#endif
 
 ImVec4 colors[] = {
     ImVec4(1.0f, 0.0f, 0.0f, 1.0f), // Red
@@ -193,7 +261,7 @@ void updateSimulationParameters()
     }
 }
 
-void processPredictionResponse(ModelInfo &model, const json &response, const std::pair<int, int> &connection)
+void processPredictionResponse(SeriesStore &predictions, const json &response, size_t connectionId, double timestamp)
 {
     float prediction = response["prediction"].get<float>();
     std::string attackType = response["attack_type"].get<std::string>();
@@ -201,18 +269,12 @@ void processPredictionResponse(ModelInfo &model, const json &response, const std
     // std::cout << attackType << std::endl;
 
     // Update plot data
-    model.plotData[0].values[connection].push_back(prediction);
-
-    // Limit the size of the plot data
-    if (model.plotData[0].values[connection].size() > 1000)
-    {
-        model.plotData[0].values[connection].erase(
-            model.plotData[0].values[connection].begin());
-    }
+    predictions.append(connectionId, prediction, timestamp);
 }
 
 std::string openFileDialog(const char *filter = "Python Files\0*.py\0All Files\0*.*\0")
 {
+#ifdef _WIN32
     OPENFILENAMEA ofn;
     char szFile[260] = {0};
     ZeroMemory(&ofn, sizeof(ofn));
@@ -231,9 +293,24 @@ std::string openFileDialog(const char *filter = "Python Files\0*.py\0All Files\0
     {
         return ofn.lpstrFile;
     }
+#else
+    (void)filter;
+    std::cerr << "File dialog is only available on Windows" << std::endl;
+#endif
     return "";
 }
 
+std::filesystem::path getExecutableDir()
+{
+#ifdef _WIN32
+    char exePath[MAX_PATH];
+    GetModuleFileNameA(NULL, exePath, MAX_PATH);
+    return std::filesystem::path(exePath).parent_path();
+#else
+    return std::filesystem::read_symlink("/proc/self/exe").parent_path();
+#endif
+}
+
 bool fileExists(const std::string &path)
 {
     return std::filesystem::exists(path);
@@ -277,6 +354,161 @@ void loadModel()
     }
 }
 
+// The .pkl a model runs from: a custom model's own file, otherwise the
+// bundled one next to the executable.
+std::filesystem::path modelFilePath(const ModelInfo &model, const std::filesystem::path &executablePath)
+{
+    return model.path.empty() ? executablePath / model.name : std::filesystem::path(model.path);
+}
+
+// Writes the native export of a .pkl with export_model.py.
+bool exportNativeModel(const std::filesystem::path &pklPath, const std::filesystem::path &nativePath,
+                       const std::filesystem::path &executablePath)
+{
+    std::filesystem::path scriptPath = executablePath / "export_model.py";
+    std::string command = "python \"" + scriptPath.string() + "\" \"" + pklPath.string() + "\" \"" +
+                          nativePath.string() + "\"";
+    std::cout << "Executing command: " << command << std::endl;
+    if (std::system(command.c_str()) != 0)
+    {
+        std::cerr << "Failed to export " << pklPath.string() << " for native inference" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const NativeModel> loadNativeModel(const std::filesystem::path &nativePath)
+{
+    auto model = std::make_shared<NativeModel>();
+    if (!model->load(nativePath))
+    {
+        return nullptr;
+    }
+    return model;
+}
+
+// Loads the native export of a model, first running export_model.py when the
+// .sgm next to the .pkl is missing, older than it, or unreadable (such as a
+// file from an older format version).
+bool loadNativeDetector(ModelInfo &model, const std::filesystem::path &executablePath)
+{
+    auto detector = std::make_shared<NativeDetector>();
+    detector->pklPath = modelFilePath(model, executablePath);
+    detector->nativePath = detector->pklPath;
+    detector->nativePath.replace_extension(".sgm");
+
+    std::error_code error;
+    detector->pklWriteTime = std::filesystem::last_write_time(detector->pklPath, error);
+    bool stale = !std::filesystem::exists(detector->nativePath, error) ||
+                 std::filesystem::last_write_time(detector->nativePath, error) < detector->pklWriteTime;
+    std::shared_ptr<const NativeModel> loaded;
+    if (!stale)
+    {
+        loaded = loadNativeModel(detector->nativePath);
+    }
+    if (!loaded)
+    {
+        if (!exportNativeModel(detector->pklPath, detector->nativePath, executablePath))
+        {
+            return false;
+        }
+        loaded = loadNativeModel(detector->nativePath);
+        if (!loaded)
+        {
+            return false;
+        }
+    }
+    detector->nativeWriteTime = std::filesystem::last_write_time(detector->nativePath, error);
+    detector->model = loaded;
+    model.detector = detector;
+    return true;
+}
+
+// Loads every selected native model for a new run, with fresh statistics.
+// Models that cannot be loaded fall back to prediction_script.py. Caller
+// holds modelsMutex.
+void prepareNativeModels(const std::filesystem::path &executablePath)
+{
+    for (auto &model : availableModels)
+    {
+        model.detector.reset();
+        if (model.selected && model.native && !loadNativeDetector(model, executablePath))
+        {
+            std::cerr << "Falling back to prediction_script.py for " << model.name << std::endl;
+            model.native = false;
+        }
+    }
+    size_t nativeCount = std::count_if(availableModels.begin(), availableModels.end(),
+                                       [](const ModelInfo &model)
+                                       { return model.detector != nullptr; });
+    size_t spareCores = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    size_t threads = std::min(nativeCount > 0 ? nativeCount - 1 : 0, spareCores);
+    nativeWorkers = threads > 0 ? std::make_shared<WorkerPool>(threads) : nullptr;
+}
+
+// Keeps running native models in step with their files while a run is
+// active: a rewritten .pkl is exported again, and a new .sgm is mapped and
+// swapped into its detector without stopping the traffic. The processing
+// thread finishes any batch it started on the old model, which is unmapped
+// when its last reference goes. A file that fails to load leaves the
+// current model in place.
+void nativeModelWatcherThread(std::filesystem::path executablePath)
+{
+    const auto POLL_INTERVAL = std::chrono::milliseconds(500);
+    while (!shouldExit)
+    {
+        for (auto waited = std::chrono::milliseconds(0); waited < POLL_INTERVAL && !shouldExit;
+             waited += std::chrono::milliseconds(50))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        if (shouldExit || !simulationRunning)
+        {
+            continue;
+        }
+
+        std::vector<std::shared_ptr<NativeDetector>> detectors;
+        {
+            std::lock_guard<std::mutex> lock(modelsMutex);
+            for (const auto &model : availableModels)
+            {
+                if (model.detector)
+                {
+                    detectors.push_back(model.detector);
+                }
+            }
+        }
+
+        for (const auto &detector : detectors)
+        {
+            std::error_code error;
+            auto pklWriteTime = std::filesystem::last_write_time(detector->pklPath, error);
+            if (!error && pklWriteTime != detector->pklWriteTime)
+            {
+                detector->pklWriteTime = pklWriteTime;
+                exportNativeModel(detector->pklPath, detector->nativePath, executablePath);
+            }
+
+            auto nativeWriteTime = std::filesystem::last_write_time(detector->nativePath, error);
+            if (error || nativeWriteTime == detector->nativeWriteTime)
+            {
+                continue;
+            }
+            detector->nativeWriteTime = nativeWriteTime;
+            auto start = std::chrono::steady_clock::now();
+            std::shared_ptr<const NativeModel> loaded = loadNativeModel(detector->nativePath);
+            if (!loaded)
+            {
+                std::cerr << "Keeping the running model for " << detector->nativePath.string() << std::endl;
+                continue;
+            }
+            std::atomic_store(&detector->model, loaded);
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            std::cout << "Reloaded " << detector->nativePath.string() << " in " << elapsed.count() << " us" << std::endl;
+        }
+    }
+}
+
 std::string getCurrentTimestamp()
 {
     auto now = std::chrono::system_clock::now();
@@ -424,6 +656,7 @@ void terminatePythonProcesses()
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
                 // Shutdown and close socket
+                model.client.reset();
                 shutdown(model.socket, SD_BOTH);
                 closesocket(model.socket);
                 model.socket = INVALID_SOCKET;
@@ -441,27 +674,130 @@ void terminatePythonProcesses()
 #endif
 }
 
+// The get_stats reply prediction_script.py would send for these statistics.
+json predictionStatsJson(const PredictionStats &stats)
+{
+    auto ratio = [](double numerator, double denominator)
+    { return denominator > 0 ? numerator / denominator : 0.0; };
+
+    json metrics;
+    double totalTp = 0, totalFp = 0, totalFn = 0, totalTn = 0;
+    for (size_t type = 0; type < ATTACK_TYPE_COUNT; ++type)
+    {
+        const PredictionStats::Counts &counts = stats.confusion(type);
+        double tp = static_cast<double>(counts.tp);
+        double fp = static_cast<double>(counts.fp);
+        double fn = static_cast<double>(counts.fn);
+        double tn = static_cast<double>(counts.tn);
+        totalTp += tp;
+        totalFp += fp;
+        totalFn += fn;
+        totalTn += tn;
+
+        double precision = ratio(tp, tp + fp);
+        double recall = ratio(tp, tp + fn);
+        metrics[ATTACK_TYPE_KEYS[type]] = {
+            {"precision", precision},
+            {"recall", recall},
+            {"f1_score", ratio(2 * precision * recall, precision + recall)},
+            {"support", stats.support(type)},
+            {"confusion_matrix", {{"tp", counts.tp}, {"fp", counts.fp}, {"tn", counts.tn}, {"fn", counts.fn}}},
+        };
+    }
+
+    double precision = ratio(totalTp, totalTp + totalFp);
+    double recall = ratio(totalTp, totalTp + totalFn);
+    json result;
+    result["accuracy"] = ratio(totalTp + totalTn, totalTp + totalTn + totalFp + totalFn);
+    result["precision"] = precision;
+    result["recall"] = recall;
+    result["f1_score"] = ratio(2 * precision * recall, precision + recall);
+    result["total_predictions"] = std::max<uint64_t>(stats.predictions(), 1);
+    result["attack_metrics"] = metrics;
+    result["avg_prediction_time"] = stats.averageMilliseconds();
+    if (stats.scores() > 0)
+    {
+        // score_samples() for isolation forests, nearest-center distance for KMeans.
+        result["anomaly_score"] = {{"mean", stats.averageScore()}, {"min", stats.minScore()}, {"max", stats.maxScore()}};
+    }
+    return result;
+}
+
 void stopSimulation()
 {
     simulationEnded = true;
     simulationRunning = false;
     modelStats.clear();
+    // Keeps the processing thread off the model connections while the
+    // predictions still in flight are collected and the stats requested.
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    // Every script is asked at once and gets the same deadline, so a hung
+    // one delays the others by at most that.
+    json request;
+    request["command"] = "get_stats";
     for (const auto &model : availableModels)
     {
-        if (model.selected && model.socket != INVALID_SOCKET)
+        if (model.selected && !model.detector && model.client)
         {
-            json request;
-            request["command"] = "get_stats";
-            std::string jsonStr = request.dump() + "\n";
-            send(model.socket, jsonStr.c_str(), jsonStr.length(), 0);
+            model.client->startCommand(request.dump());
+        }
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (true)
+    {
+        bool waiting = false;
+        for (size_t m = 0; m < availableModels.size(); ++m)
+        {
+            const ModelInfo &model = availableModels[m];
+            if (!model.selected || model.detector || !model.client || !model.client->connected())
+            {
+                continue;
+            }
+            model.client->poll([m](const PredictionClient::Completion &completion)
+                               {
+                                   if (m < predictionSeries.size())
+                                   {
+                                       predictionSeries[m].append(completion.connectionId, completion.prediction,
+                                                                  completion.timestamp);
+                                   }
+                               });
+            waiting |= !model.client->replyReady();
+        }
+        if (!waiting || std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
 
-            char recvbuf[1024];
-            int iResult = recv(model.socket, recvbuf, 1024, 0);
-            if (iResult > 0)
+    for (const auto &model : availableModels)
+    {
+        if (model.selected && model.detector)
+        {
+            json stats = predictionStatsJson(model.detector->stats);
+            stats["model_name"] = model.name;
+            modelStats.push_back(stats);
+        }
+        else if (model.selected && model.client)
+        {
+            PredictionClient &client = *model.client;
+            if (client.dropped() > 0)
+            {
+                std::cerr << model.name << " fell behind the feed; " << client.dropped() << " records were not scored ("
+                          << client.timedOut() << " timed out)" << std::endl;
+            }
+            if (!client.replyReady())
+            {
+                std::cerr << "No statistics from " << model.name << std::endl;
+                continue;
+            }
+            json stats = json::parse(client.takeReply(), nullptr, false);
+            if (stats.is_object())
             {
-                std::string response(recvbuf, iResult);
-                json stats = json::parse(response);
                 stats["model_name"] = model.name;
+                stats["dropped_requests"] = client.dropped();
+                stats["timed_out_requests"] = client.timedOut();
                 modelStats.push_back(stats);
             }
         }
@@ -560,30 +896,29 @@ void runSimulation()
     std::cout << "Z... (Finished runSimulation)" << std::endl;
 }
 
-std::queue<std::vector<float>> predictionQueue;
+std::queue<Record> predictionQueue;
 std::mutex predictionQueueMutex;
 std::atomic<bool> predictionReceiverRunning(true);
 
-void sendDataToPredictionScript(const std::vector<float> &data)
+// Every model feature plus the ground-truth attack flags prediction_script.py
+// scores its predictions against, keyed as in RECORD_SCHEMA.
+json buildPredictionRequest(const Record &data)
+{
+    json j;
+    forEachModelFeature(data, [&j](const char *key, float value)
+                        { j[key] = value; });
+    forEachAttackLabel(data, [&j](const char *key, int flag)
+                       { j[key] = flag; });
+    return j;
+}
+
+void sendDataToPredictionScript(const Record &data)
 {
     try
     {
-        json j;
-        j["FB"] = data[0];
-        j["TB"] = data[1];
-        j["IAT"] = data[2];
-        j["TD"] = data[3];
-        j["Arrival Time"] = data[4];
-        j["PC"] = data[5];
-        j["Packet Size"] = data[6];
-        j["Acknowledgement Packet Size"] = data[7];
-        j["RTT"] = data[8];
-        j["Average Queue Size"] = data[9];
-        j["System Occupancy"] = data[10];
-        j["Arrival Rate"] = data[11];
-        j["Service Rate"] = data[12];
-        j["Packet Dropped"] = data[13];
-        j["Is Attack"] = data[16]; 
+        json j = buildPredictionRequest(data);
+        j[RECORD_SCHEMA[0].jsonKey] = data.fb;
+        j[RECORD_SCHEMA[1].jsonKey] = data.tb;
         std::string jsonStr = j.dump();
         SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
         if (sock == INVALID_SOCKET)
@@ -612,30 +947,31 @@ void sendDataToPredictionScript(const std::vector<float> &data)
         std::cerr << "Error sending data to prediction script: " << e.what() << std::endl;
     }
 }
+// Connects to the prediction script of every selected model not run in
+// process. The scripts were just started and take a moment to load their
+// model, so each connection is retried until it is accepted or
+// STARTUP_TIMEOUT_MS has passed.
 bool initPredictionSocket()
 {
-    const int MAX_RETRIES = 10;
-    const int RETRY_DELAY_MS = 500;
+    const int STARTUP_TIMEOUT_MS = 15000;
+    const int RETRY_DELAY_MS = 100;
 
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(STARTUP_TIMEOUT_MS);
     for (auto &model : availableModels)
     {
-        if (model.selected)
+        if (model.selected && !model.detector)
         {
             bool connected = false;
-            for (int retry = 0; retry < MAX_RETRIES && !connected; ++retry)
+            bool waiting = false;
+            int lastError = 0;
+            while (!connected && !applicationClosing)
             {
-                if (retry > 0)
-                {
-                    std::cout << "Retry " << retry << " for " << model.name << std::endl;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_DELAY_MS));
-                }
-
                 model.socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
                 if (model.socket == INVALID_SOCKET)
                 {
                     std::cerr << "Error creating prediction socket for " << model.name
                               << ": " << WSAGetLastError() << std::endl;
-                    continue;
+                    return false;
                 }
 
                 sockaddr_in serverAddr;
@@ -643,219 +979,322 @@ bool initPredictionSocket()
                 serverAddr.sin_port = htons(model.port);
                 inet_pton(AF_INET, "127.0.0.1", &serverAddr.sin_addr);
 
-                if (connect(model.socket, (SOCKADDR *)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR)
+                if (connect(model.socket, (SOCKADDR *)&serverAddr, sizeof(serverAddr)) != SOCKET_ERROR)
                 {
-                    std::cerr << "Connect attempt " << retry + 1 << " failed for " << model.name
-                              << " with error: " << WSAGetLastError() << std::endl;
-                    closesocket(model.socket);
-                    model.socket = INVALID_SOCKET;
-                    continue;
+                    connected = true;
+                    break;
                 }
-
-                std::cout << "Successfully connected to " << model.name
-                          << " on port " << model.port << std::endl;
-                connected = true;
+                lastError = WSAGetLastError();
+                closesocket(model.socket);
+                model.socket = INVALID_SOCKET;
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    break;
+                }
+                if (!waiting)
+                {
+                    std::cout << "Waiting for " << model.name << " to start listening on port "
+                              << model.port << "..." << std::endl;
+                    waiting = true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_DELAY_MS));
             }
 
             if (!connected)
             {
-                std::cerr << "Failed to connect to " << model.name
-                          << " after " << MAX_RETRIES << " attempts" << std::endl;
+                std::cerr << "Failed to connect to " << model.name << " within "
+                          << STARTUP_TIMEOUT_MS / 1000 << " s, last error: " << lastError << std::endl;
                 return false;
             }
+            std::cout << "Successfully connected to " << model.name
+                      << " on port " << model.port << std::endl;
+            setSocketNonBlocking(model.socket);
+            model.client = std::make_shared<PredictionClient>(model.socket, model.name, model.inFlightWindow);
         }
     }
     return true;
 }
-float getPredictionFromPython(const std::vector<float> &data, const std::string &modelName)
+
+// Returns the dense id of an (FB, TB) pair, assigning the next free one the
+// first time the pair is seen.
+size_t internConnection(int fb, int tb)
 {
-    auto it = std::find_if(availableModels.begin(), availableModels.end(),
-                           [&modelName](const ModelInfo &model)
-                           { return model.name == modelName; });
-    if (it == availableModels.end() || it->socket == INVALID_SOCKET)
+    uint32_t id = connectionIndex.intern(fb, tb);
+    if (id == connectionLabels.size())
     {
-        std::cerr << "Invalid socket for " << modelName << std::endl;
-        return 0.0f;
+        connectionLabels.push_back("FB" + std::to_string(fb) + " -> TB" + std::to_string(tb));
     }
-    json j;
-    j["model"] = modelName;
-    j["IAT"] = data[2];
-    j["TD"] = data[3];
-    j["Arrival Time"] = data[4];
-    j["PC"] = data[5];
-    j["Packet Size"] = data[6];
-    j["Acknowledgement Packet Size"] = data[7];
-    j["RTT"] = data[8];
-    j["Average Queue Size"] = data[9];
-    j["System Occupancy"] = data[10];
-    j["Arrival Rate"] = data[11];
-    j["Service Rate"] = data[12];
-    j["Packet Dropped"] = data[13];
-    j["Is Attack"] = data[16];
-    std::string jsonStr = j.dump();
-    if (send(it->socket, jsonStr.c_str(), jsonStr.length(), 0) == SOCKET_ERROR)
-    {
-        std::cerr << "Send failed for " << modelName << " with error: " << WSAGetLastError() << std::endl;
-        return 0.0f;
-    }
-    char recvbuf[1024];
-    int iResult = recv(it->socket, recvbuf, 1024, 0);
-    if (iResult > 0)
-    {
-        std::string response(recvbuf, iResult);
-        json responseJson = json::parse(response);
-        return responseJson["prediction"].get<float>();
-    }
-    else if (iResult == 0)
-    {
-        std::cout << "Connection closed for " << modelName << std::endl;
+    return id;
+}
+
+struct PredictionTarget
+{
+    size_t index;
+    std::shared_ptr<PredictionClient> client; // set for models behind prediction_script.py
+    std::shared_ptr<NativeDetector> detector; // set for models run in process
+    size_t window;
+    std::chrono::milliseconds timeout;
+    size_t batch;
+    std::chrono::milliseconds batchDelay;
+};
+
+// Scores one batch with an in-process model and appends the predictions to
+// its series. features holds MODEL_FEATURE_COUNT values per record.
+void runNativeModel(NativeDetector &detector, SeriesStore &predictions, const Record *records,
+                    const float (*features)[MODEL_FEATURE_COUNT], const size_t *connectionIds, size_t count)
+{
+    // Per thread: several models of one batch are scored at once.
+    thread_local std::vector<uint32_t> classes;
+    thread_local std::vector<double> scores;
+    classes.resize(count);
+    scores.resize(count);
+    // One model for the whole batch, even if a reload swaps it meanwhile.
+    std::shared_ptr<const NativeModel> model = std::atomic_load(&detector.model);
+    bool scored = model->hasScores();
+    auto start = std::chrono::steady_clock::now();
+    model->predict(features[0], count, classes.data(), scored ? scores.data() : nullptr, anomalyThreshold.load());
+    detector.stats.addTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    for (size_t b = 0; b < count; ++b)
+    {
+        if (scored)
+        {
+            detector.stats.addScore(scores[b]);
+        }
+        int predicted = model->attackCode(classes[b]);
+        detector.stats.update(predicted, static_cast<int>(attackTypeCode(records[b])));
+        predictions.append(connectionIds[b], predicted != 0 ? 1.0f : 0.0f, records[b].timestamp);
     }
-    else
+}
+
+// Appends every prediction that has come back from the prediction scripts
+// to its model's series. Returns the number collected.
+size_t collectPredictions(const std::vector<PredictionTarget> &targets)
+{
+    size_t completed = 0;
+    for (const auto &target : targets)
     {
-        std::cerr << "Recv failed for " << modelName << " with error: " << WSAGetLastError() << std::endl;
+        if (target.client)
+        {
+            SeriesStore &predictions = predictionSeries[target.index];
+            completed += target.client->poll([&predictions](const PredictionClient::Completion &completion)
+                                             { predictions.append(completion.connectionId, completion.prediction,
+                                                                  completion.timestamp); });
+        }
     }
-    return 0.0f;
+    return completed;
 }
 
-void processData()
+// Pops and processes at most one batch of ingested records: updates the
+// live series, runs the in-process models and queues requests for the
+// prediction scripts, whose answers are collected as they arrive. Called
+// only from the processing thread. Returns the number of records and
+// predictions handled.
+size_t processData()
 {
+    const size_t BATCH_SIZE = 256;
+    static Record batch[BATCH_SIZE];
     std::lock_guard<std::mutex> lock(queueMutex);
-    while (!dataQueue.empty())
-    {
-        std::vector<float> data = dataQueue.front();
-        dataQueue.pop();
+    size_t batchCount = dataQueue.pop(batch, BATCH_SIZE);
 
-        if (data.size() >= 20)
+    static size_t appliedRetention = 0;
+    static float appliedRetentionSeconds = -1.0f;
+    size_t retention = seriesRetention.load();
+    float retentionSeconds = seriesRetentionSeconds.load();
+    if (retention != appliedRetention || retentionSeconds != appliedRetentionSeconds)
+    {
+        metricSeries.setRetention(retention);
+        metricSeries.setRetentionSeconds(retentionSeconds);
+        for (auto &predictions : predictionSeries)
         {
-            int fb = static_cast<int>(data[0]);
-            int tb = static_cast<int>(data[1]);
-            std::pair<int, int> connection(fb, tb);
+            predictions.setRetention(retention);
+            predictions.setRetentionSeconds(retentionSeconds);
+        }
+        appliedRetention = retention;
+        appliedRetentionSeconds = retentionSeconds;
+    }
 
-            if (fbTbCombinations.find(connection) == fbTbCombinations.end())
+    // Copy the selection so the UI can keep editing the model list while
+    // predictions are in flight.
+    std::vector<PredictionTarget> targets;
+    std::shared_ptr<WorkerPool> workers;
+    {
+        std::lock_guard<std::mutex> modelsLock(modelsMutex);
+        workers = nativeWorkers;
+        if (predictionSeries.size() != availableModels.size())
+        {
+            SeriesStore emptyPredictions(1, retention, retentionSeconds);
+            if (!seriesSpillDirectory.empty())
             {
-                fbTbCombinations[connection] = fbTbCombinations.size();
+                emptyPredictions.enableSpill(seriesSpillDirectory);
             }
-
-            // Create AttackInfo structure
-            AttackInfo attackInfo;
-            attackInfo.none = data[16] > 0.5f;
-            attackInfo.ddos = data[17] > 0.5f;
-            attackInfo.synflood = data[18] > 0.5f;
-            attackInfo.mitm = data[19] > 0.5f;
-
-            std::cout << "Received data point with " << data.size() << " elements" << std::endl;
-            std::cout << "CPP DATA ENQUEUE [ ";
-            for (const auto &value : data)
+            predictionSeries.resize(availableModels.size(), emptyPredictions);
+        }
+        for (size_t m = 0; m < availableModels.size(); ++m)
+        {
+            const ModelInfo &model = availableModels[m];
+            if (model.selected && (model.detector || model.client))
             {
-                std::cout << value << " ";
+                targets.push_back({m, model.client, model.detector, static_cast<size_t>(model.inFlightWindow),
+                                   std::chrono::milliseconds(model.predictionTimeoutMs),
+                                   static_cast<size_t>(model.predictionBatch),
+                                   std::chrono::milliseconds(model.batchDelayMs)});
             }
-            std::cout << "]" << std::endl;
+        }
+    }
+    if (batchCount == 0)
+    {
+        return collectPredictions(targets);
+    }
 
-            // Process all metrics
-            for (int i = 0; i < metricLabels.size(); ++i)
-            {
-                std::lock_guard<std::mutex> lock(plotDataMutexes[i]);
-                float value = 0.0f;
-                switch (i)
-                {
-                case 0: // Packets Dropped
-                    value = data[13];
-                    break;
-                case 1: // Average Queue Size
-                    value = data[9];
-                    break;
-                case 2: // System Occupancy
-                    value = data[10];
-                    break;
-                case 3: // Service Rate
-                    value = data[12];
-                    break;
-                case 4: // Transmission Delay
-                    value = data[3];
-                    break;
-                case 5: // Round Trip Time (RTT)
-                    value = data[8];
-                    break;
-                case 6: // Arrival Rate
-                    value = data[11];
-                    break;
-                case 7: // Attack Type Distribution
-                    if (attackInfo.ddos)
-                        value = 1.0f;
-                    else if (attackInfo.synflood)
-                        value = 2.0f;
-                    else if (attackInfo.mitm)
-                        value = 3.0f;
-                    else
-                        value = 0.0f;
-                    break;
-                case 8: // Packet Size
-                    value = data[6];
-                    break;
-                case 9: // IAT
-                    value = data[2];
-                    break;
-                case 10: // Acknowledgement Size
-                    value = data[7];
-                    break;
-                case 11: // Packet Count (PC)
-                    value = data[5];
-                    
-                    break;
-                default:
-                    value = 0.0f;
-                }
-                plotDataArray[i].values[connection].push_back(value);
+    bool anyRemote = std::any_of(targets.begin(), targets.end(),
+                                 [](const PredictionTarget &target)
+                                 { return target.client != nullptr; });
+    for (const auto &target : targets)
+    {
+        if (target.client)
+        {
+            target.client->setWindow(target.window);
+            target.client->setTimeout(target.timeout);
+            target.client->setBatching(target.batch, target.batchDelay);
+        }
+    }
+    static float features[BATCH_SIZE][MODEL_FEATURE_COUNT];
+    static size_t connectionIds[BATCH_SIZE];
 
-                // Limit data points for each metric
-                if (plotDataArray[i].values[connection].size() > 1000)
-                {
-                    plotDataArray[i].values[connection].erase(
-                        plotDataArray[i].values[connection].begin());
-                }
-            }
+    for (size_t b = 0; b < batchCount; ++b)
+    {
+        const Record &data = batch[b];
+        size_t connectionId = internConnection(static_cast<int>(data.fb), static_cast<int>(data.tb));
 
-            // Process model predictions
-            for (auto &model : availableModels)
+        // Process all metrics
+        float metricValues[PLOT_METRIC_COUNT];
+        extractPlotValues(data, metricValues);
+        metricSeries.append(connectionId, metricValues, data.timestamp);
+        metricStats.update(connectionId, metricValues, data.timestamp);
+
+        // Process model predictions
+        if (targets.empty())
+        {
+            continue;
+        }
+        extractModelFeatures(data, features[b]);
+        connectionIds[b] = connectionId;
+        if (!anyRemote)
+        {
+            continue;
+        }
+        std::string request = buildPredictionRequest(data).dump();
+        for (const auto &target : targets)
+        {
+            if (target.client)
             {
-                if (model.selected)
-                {
-                    // Create prediction request
-                    json predictionRequest;
-                    predictionRequest["IAT"] = data[2];
-                    predictionRequest["TD"] = data[3];
-                    predictionRequest["Arrival Time"] = data[4];
-                    predictionRequest["PC"] = data[5];
-                    predictionRequest["Packet Size"] = data[6];
-                    predictionRequest["Acknowledgement Packet Size"] = data[7];
-                    predictionRequest["RTT"] = data[8];
-                    predictionRequest["Average Queue Size"] = data[9];
-                    predictionRequest["System Occupancy"] = data[10];
-                    predictionRequest["Arrival Rate"] = data[11];
-                    predictionRequest["Service Rate"] = data[12];
-                    predictionRequest["Packet Dropped"] = data[13];
-                    predictionRequest["attack_none"] = attackInfo.none;
-                    predictionRequest["attack_ddos"] = attackInfo.ddos;
-                    predictionRequest["attack_synflood"] = attackInfo.synflood;
-                    predictionRequest["attack_mitm"] = attackInfo.mitm;
-
-                    std::string jsonStr = predictionRequest.dump();
-                    if (send(model.socket, jsonStr.c_str(), jsonStr.length(), 0) != SOCKET_ERROR)
-                    {
-                        char recvbuf[1024];
-                        int iResult = recv(model.socket, recvbuf, 1024, 0);
-                        if (iResult > 0)
-                        {
-                            std::string response(recvbuf, iResult);
-                            json responseJson = json::parse(response);
-                            float prediction = responseJson["prediction"].get<float>();
-                            model.plotData[0].values[connection].push_back(prediction);
-                        }
-                    }
-                }
+                target.client->submit(request, connectionId, data.timestamp);
             }
         }
     }
+
+    // In-process models score the whole batch in one pass each, side by
+    // side on the run's worker pool once the batch is worth the handoff.
+    // Each writes only its own detector and series. Batches stay below
+    // PARALLEL_MIN_ROWS, so a forest never starts threads of its own here.
+    static_assert(BATCH_SIZE < TreeEnsemble::PARALLEL_MIN_ROWS, "native scoring must stay on the pool");
+    const size_t PARALLEL_MIN_RECORDS = 64;
+    static std::vector<const PredictionTarget *> nativeTargets;
+    nativeTargets.clear();
+    for (const auto &target : targets)
+    {
+        if (target.detector)
+        {
+            nativeTargets.push_back(&target);
+        }
+    }
+    auto scoreNative = [batchCount](size_t n)
+    {
+        const PredictionTarget &target = *nativeTargets[n];
+        runNativeModel(*target.detector, predictionSeries[target.index], batch, features, connectionIds, batchCount);
+    };
+    if (workers && batchCount >= PARALLEL_MIN_RECORDS)
+    {
+        workers->run(nativeTargets.size(), scoreNative);
+    }
+    else
+    {
+        for (size_t n = 0; n < nativeTargets.size(); ++n)
+        {
+            scoreNative(n);
+        }
+    }
+    recordsProcessed.fetch_add(batchCount, std::memory_order_relaxed);
+    return batchCount + collectPredictions(targets);
+}
+
+// Copies the live series into the spare snapshot buffer, reusing its
+// storage, and hands it to the renderer. Never waits for the render thread.
+// Caller holds queueMutex.
+void publishPlotSnapshot()
+{
+    PlotSnapshot &snapshot = plotSnapshots.writeBuffer();
+    snapshot.metrics.syncFrom(metricSeries);
+    snapshot.stats.syncFrom(metricStats);
+    snapshot.predictions.resize(predictionSeries.size());
+    for (size_t m = 0; m < predictionSeries.size(); ++m)
+    {
+        snapshot.predictions[m].syncFrom(predictionSeries[m]);
+    }
+    if (snapshot.connectionEpoch != connectionEpoch)
+    {
+        snapshot.connectionLabels.clear();
+        snapshot.connectionEpoch = connectionEpoch;
+    }
+    snapshot.connectionLabels.insert(snapshot.connectionLabels.end(),
+                                     connectionLabels.begin() + snapshot.connectionLabels.size(),
+                                     connectionLabels.end());
+    plotSnapshots.publish();
+}
+
+// Drops all ingested and plotted data, e.g. when a new capture starts.
+void resetSeries()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    dataQueue.clear();
+    metricSeries.clear();
+    metricStats.clear();
+    predictionSeries.clear();
+    connectionIndex.clear();
+    connectionLabels.clear();
+    ++connectionEpoch;
+    publishPlotSnapshot();
+}
+
+// Pipeline stage between ingest and the UI. Consumes dataQueue while a run
+// is active and republishes the plot snapshot at most once per frame
+// interval, or as soon as the queue runs dry.
+void processingThread()
+{
+    const auto PUBLISH_INTERVAL = std::chrono::milliseconds(16);
+    auto lastPublish = std::chrono::steady_clock::now();
+    bool unpublished = false;
+
+    while (!shouldExit)
+    {
+        size_t processed = simulationRunning ? processData() : 0;
+        unpublished = unpublished || processed > 0;
+
+        auto now = std::chrono::steady_clock::now();
+        if (unpublished && (processed == 0 || now - lastPublish >= PUBLISH_INTERVAL))
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            publishPlotSnapshot();
+            unpublished = false;
+            lastPublish = now;
+        }
+
+        if (processed == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
 }
 
 void simulationThread()
@@ -921,9 +1360,9 @@ void simulationThread()
         Py_XDECREF(pFunc);
         Py_DECREF(pModule);
 
-        while (!dataQueue.empty())
+        // Let the processing thread drain what the simulation sent.
+        while (!dataQueue.empty() && !shouldExit)
         {
-            processData();
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
     }
@@ -977,12 +1416,83 @@ void handleGlobalScroll(float newScrollX, bool fromPlot)
     }
 }
 
-void renderPlots()
+// Visible part of the capture, shared by every plot so that connections
+// reporting at different rates line up. Times are seconds since the first
+// record still readable; plots scroll together through globalScrollX.
+struct TimeWindow
+{
+    double origin = 0.0; // timestamp at x = 0
+    double span = 0.0;   // seconds from the first to the last record
+    double width = 1.0;  // seconds across one plot width
+};
+
+TimeWindow plotTimeWindow(const PlotSnapshot &snapshot)
+{
+    TimeWindow window;
+    double last = 0.0;
+    if (snapshot.metrics.timeSpan(window.origin, last))
+    {
+        window.span = last - window.origin;
+    }
+    window.width = showWholeCapture ? std::max(window.span, 1e-3) : static_cast<double>(visibleSeconds);
+    return window;
+}
+
+// Rows of values stamped in [from, to), in seconds after timeOrigin.
+std::pair<size_t, size_t> visibleRows(const SeriesColumn &values, double timeOrigin, double from, double to)
+{
+    return {values.lowerBound(timeOrigin + from), values.lowerBound(timeOrigin + to)};
+}
+
+// Calls fn(x, value) for at most `pixels` markers over rows [first, last),
+// with x in seconds after timeOrigin: every sample when they fit, otherwise
+// the largest sample of each pixel column so a lone attack marker is never
+// dropped.
+template <typename Fn>
+void forEachVisibleMarker(const SeriesColumn &values, size_t first, size_t last, int pixels, double timeOrigin,
+                          Fn &&fn)
+{
+    if (last - first <= static_cast<size_t>(std::max(pixels, 1)))
+    {
+        for (size_t j = first; j < last; ++j)
+        {
+            fn(values.time(j) - timeOrigin, values[j]);
+        }
+        return;
+    }
+
+    static std::vector<float> mins, maxs;
+    size_t bucketCount = static_cast<size_t>(pixels);
+    mins.resize(bucketCount);
+    maxs.resize(bucketCount);
+    values.buckets(first, last, bucketCount, mins.data(), maxs.data());
+    double bucketWidth = static_cast<double>(last - first) / bucketCount;
+    for (size_t b = 0; b < bucketCount; ++b)
+    {
+        if (mins[b] <= maxs[b])
+        {
+            fn(values.time(first + static_cast<size_t>((b + 0.5) * bucketWidth)) - timeOrigin, maxs[b]);
+        }
+    }
+}
+
+void renderPlots(const PlotSnapshot &snapshot)
 {
     ImPlotFlags flags = ImPlotFlags_NoMouseText;
     ImPlotAxisFlags axes_flags = ImPlotAxisFlags_NoTickLabels;
-    const int VISIBLE_POINTS = 100;
     static std::vector<bool> showLegends(metricLabels.size(), false);
+    static std::vector<int> downsampleModes(metricLabels.size(), static_cast<int>(DownsampleMode::M4));
+    static std::vector<std::vector<Downsampler>> downsamplers(metricLabels.size()); // [metric][connection]
+    static uint64_t downsampleEpoch = 0;
+
+    if (downsampleEpoch != snapshot.connectionEpoch)
+    {
+        for (auto &perConnection : downsamplers)
+        {
+            perConnection.clear();
+        }
+        downsampleEpoch = snapshot.connectionEpoch;
+    }
 
     for (size_t i = 0; i < metricLabels.size(); ++i)
     {
@@ -991,6 +1501,12 @@ void renderPlots()
             ImGui::BeginChild(metricLabels[i].c_str(), ImVec2(0, 250), true);
 
             ImGui::Text("%s", metricLabels[i].c_str());
+            if (i != ATTACK_TYPE_PLOT_SLOT)
+            {
+                ImGui::SameLine(ImGui::GetWindowWidth() - 160);
+                ImGui::SetNextItemWidth(80);
+                ImGui::Combo(("##downsample" + std::to_string(i)).c_str(), &downsampleModes[i], "M4\0LTTB\0");
+            }
             ImGui::SameLine(ImGui::GetWindowWidth() - 70);
             std::string buttonLabel = (showLegends[i] ? "Hide" : "Show");
             buttonLabel += " Legend##";
@@ -1000,14 +1516,11 @@ void renderPlots()
                 showLegends[i] = !showLegends[i];
             }
 
-            int maxDataLength = 0;
-            for (const auto &[connection, values] : plotDataArray[i].values)
-            {
-                maxDataLength = std::max(maxDataLength, static_cast<int>(values.size()));
-            }
+            const SeriesStore &metrics = snapshot.metrics;
+            TimeWindow window = plotTimeWindow(snapshot);
 
             float plotWidth = ImGui::GetContentRegionAvail().x;
-            float totalWidth = std::max(plotWidth, (maxDataLength * plotWidth) / VISIBLE_POINTS);
+            float totalWidth = std::max(plotWidth, static_cast<float>(window.span / window.width) * plotWidth);
 
             ImGui::BeginChild(("ScrollingRegion##" + std::to_string(i)).c_str(),
                               ImVec2(0, 200), true,
@@ -1023,7 +1536,7 @@ void renderPlots()
                 ImGui::SetScrollX(globalScrollX);
             }
 
-            if (simulationRunning && maxDataLength > VISIBLE_POINTS)
+            if (simulationRunning && window.span > window.width)
             {
                 float maxScroll = ImGui::GetScrollMaxX();
                 handleGlobalScroll(maxScroll, true);
@@ -1039,33 +1552,28 @@ void renderPlots()
                                   ImVec2(totalWidth, -1),
                                   plot_flags))
             {
-                ImPlot::SetupAxes("Data Point", metricLabels[i].c_str(), axes_flags, axes_flags);
+                ImPlot::SetupAxes("Time (s)", metricLabels[i].c_str(), axes_flags, axes_flags);
 
                 float scrollX = ImGui::GetScrollX();
-                int startPoint = static_cast<int>((scrollX / totalWidth) * maxDataLength);
-                int endPoint = startPoint + VISIBLE_POINTS;
+                double startTime = (scrollX / totalWidth) * window.span;
+                double endTime = startTime + window.width;
 
                 double y_min = std::numeric_limits<double>::max();
                 double y_max = std::numeric_limits<double>::lowest();
 
-                for (const auto &[connection, values] : plotDataArray[i].values)
+                for (size_t id = 0; id < metrics.connectionCount(); ++id)
                 {
-                    if (!values.empty())
+                    SeriesColumn values = metrics.column(id, i);
+                    auto [startIdx, endIdx] = visibleRows(values, window.origin, startTime, endTime);
+                    float low, high;
+                    if (values.range(startIdx, endIdx, low, high))
                     {
-                        size_t endIdx = std::min<size_t>(endPoint, values.size());
-                        size_t startIdx = std::min<size_t>(startPoint, values.size());
-
-                        if (startIdx < endIdx)
-                        {
-                            auto start_it = values.begin() + startIdx;
-                            auto end_it = values.begin() + endIdx;
-                            y_min = std::min(y_min, static_cast<double>(*std::min_element(start_it, end_it)));
-                            y_max = std::max(y_max, static_cast<double>(*std::max_element(start_it, end_it)));
-                        }
+                        y_min = std::min(y_min, static_cast<double>(low));
+                        y_max = std::max(y_max, static_cast<double>(high));
                     }
                 }
 
-                if (i == 7)
+                if (i == ATTACK_TYPE_PLOT_SLOT)
                 {
                     y_min = -0.2;
                     y_max = 1.2;
@@ -1077,54 +1585,73 @@ void renderPlots()
                     y_max += y_range * 0.1;
                 }
 
-                ImPlot::SetupAxisLimits(ImAxis_X1, startPoint, endPoint, ImGuiCond_Always);
+                ImPlot::SetupAxisLimits(ImAxis_X1, startTime, endTime, ImGuiCond_Always);
                 ImPlot::SetupAxisLimits(ImAxis_Y1, y_min, y_max, ImGuiCond_Always);
 
-                for (const auto &[connection, values] : plotDataArray[i].values)
+                for (size_t id = 0; id < metrics.connectionCount(); ++id)
                 {
+                    SeriesColumn values = metrics.column(id, i);
                     if (!values.empty())
                     {
-                        std::string label = "FB" + std::to_string(connection.first) +
-                                            " -> TB" + std::to_string(connection.second);
+                        const std::string &label = snapshot.connectionLabels[id];
 
-                        size_t endIdx = std::min<size_t>(endPoint, values.size());
-                        size_t startIdx = std::min<size_t>(startPoint, values.size());
+                        auto [startIdx, endIdx] = visibleRows(values, window.origin, startTime, endTime);
 
-                        if (startIdx < endIdx)
+                        if (i == ATTACK_TYPE_PLOT_SLOT)
                         {
-                            std::vector<double> x_values;
-                            std::vector<double> y_values;
-                            x_values.reserve(endIdx - startIdx);
-                            y_values.reserve(endIdx - startIdx);
-
-                            for (size_t j = startIdx; j < endIdx; ++j)
+                            forEachVisibleMarker(values, startIdx, endIdx, static_cast<int>(plotWidth), window.origin,
+                                                 [&](double x, float value)
+                                                 {
+                                                     int attackType = static_cast<int>(value);
+                                                     double y = attackType == 0 ? 0.0 : 1.0;
+                                                     ImPlot::SetNextMarkerStyle(ImPlotMarker_Square, 4, ATTACK_COLORS[attackType]);
+                                                     ImPlot::PlotScatter(label.c_str(), &x, &y, 1);
+                                                 });
+                        }
+                        else // Line plots for non-attack metrics
+                        {
+                            // Hand ImPlot at most about two points per pixel column,
+                            // cached per zoom level. This also pages in rows that
+                            // were spilled out of memory.
+                            if (downsamplers[i].size() <= id)
                             {
-                                x_values.push_back(static_cast<double>(j));
-                                if (i == 7) // Attack Type plot
-                                {
-                                    int attackType = static_cast<int>(values[j]);
-                                    ImPlot::SetNextMarkerStyle(ImPlotMarker_Square, 4, ATTACK_COLORS[attackType]);
-                                    ImPlot::PlotScatter(label.c_str(),
-                                                        &x_values.back(),
-                                                        &(y_values.emplace_back(attackType == 0 ? 0.0 : 1.0)),
-                                                        1);
-                                }
-                                else // Other metrics
-                                {
-                                    y_values.push_back(static_cast<double>(values[j]));
-                                }
+                                downsamplers[i].resize(id + 1);
                             }
+                            // One row past each edge so the line runs off the plot
+                            // instead of stopping short of it.
+                            size_t first = startIdx > 0 ? startIdx - 1 : 0;
+                            size_t last = std::min(endIdx + 1, values.size());
+                            Downsampler &downsampler = downsamplers[i][id];
+                            downsampler.update(values, first, last, static_cast<size_t>(2 * plotWidth),
+                                               static_cast<DownsampleMode>(downsampleModes[i]), window.origin);
+                            ImPlot::SetNextLineStyle(colors[id % MAX_LINES]);
+                            ImPlot::PlotLine(label.c_str(), downsampler.xs().data(), downsampler.ys().data(),
+                                             downsampler.pointCount());
+                        }
+                    }
+                }
 
-                            if (i != 7) // Line plots for non-attack metrics
-                            {
-                                ImPlot::SetNextLineStyle(colors[fbTbCombinations[connection] % MAX_LINES]);
-                                ImPlot::PlotLine(label.c_str(),
-                                                 x_values.data(),
-                                                 y_values.data(),
-                                                 static_cast<int>(y_values.size()));
-                            }
+                // Per-connection summary, read straight from the running stats.
+                if (ImPlot::IsPlotHovered() && i != ATTACK_TYPE_PLOT_SLOT)
+                {
+                    ImGui::BeginTooltip();
+                    size_t shown = std::min<size_t>(snapshot.stats.connectionCount(), MAX_LINES);
+                    for (size_t id = 0; id < shown; ++id)
+                    {
+                        const RunningStats &stats = snapshot.stats.metric(id, i);
+                        if (stats.count == 0)
+                        {
+                            continue;
                         }
+                        ImGui::Text("%s: mean %.4g, sd %.4g, ewma %.4g, min %.4g, max %.4g, %.1f records/s",
+                                    snapshot.connectionLabels[id].c_str(), stats.mean, stats.stddev(), stats.ewma,
+                                    stats.min, stats.max, snapshot.stats.rate(id));
                     }
+                    if (snapshot.stats.connectionCount() > shown)
+                    {
+                        ImGui::TextDisabled("+%zu more connections", snapshot.stats.connectionCount() - shown);
+                    }
+                    ImGui::EndTooltip();
                 }
                 ImPlot::EndPlot();
             }
@@ -1135,31 +1662,35 @@ void renderPlots()
     }
 }
 
-void renderModelPlots()
+void renderModelPlots(const PlotSnapshot &snapshot)
 {
     ImPlotFlags flags = ImPlotFlags_NoMouseText;
     ImPlotAxisFlags axes_flags = ImPlotAxisFlags_NoTickLabels;
-    const int VISIBLE_POINTS = 100;
     static std::vector<bool> showLegends(availableModels.size(), false);
+    static const SeriesStore noPredictions;
 
     for (const auto &model : availableModels)
     {
         if (model.selected)
         {
+            size_t modelIndex = &model - &availableModels[0];
+            const SeriesStore &predictions = modelIndex < snapshot.predictions.size()
+                                              ? snapshot.predictions[modelIndex]
+                                              : noPredictions;
             std::string plotLabel = model.name + " Prediction";
             ImGui::BeginChild(plotLabel.c_str(), ImVec2(0, 250), true);
 
             ImGui::Text("%s", plotLabel.c_str());
             ImGui::SameLine(ImGui::GetWindowWidth() - 70);
-            std::string buttonLabel = (showLegends[&model - &availableModels[0]] ? "Hide" : "Show");
+            std::string buttonLabel = (showLegends[modelIndex] ? "Hide" : "Show");
             buttonLabel += " Legend##";
             buttonLabel += model.name;
             if (ImGui::Button(buttonLabel.c_str()))
             {
-                showLegends[&model - &availableModels[0]] = !showLegends[&model - &availableModels[0]];
+                showLegends[modelIndex] = !showLegends[modelIndex];
             }
 
-            if (showLegends[&model - &availableModels[0]])
+            if (showLegends[modelIndex])
             {
                 ImGui::ColorButton("##Normal", ATTACK_COLORS[0], 0, ImVec2(15, 15));
                 ImGui::SameLine();
@@ -1178,14 +1709,10 @@ void renderModelPlots()
                 ImGui::Text("MITM");
             }
 
-            int maxDataLength = 0;
-            for (const auto &[connection, values] : model.plotData[0].values)
-            {
-                maxDataLength = std::max(maxDataLength, static_cast<int>(values.size()));
-            }
+            TimeWindow window = plotTimeWindow(snapshot);
 
             float plotWidth = ImGui::GetContentRegionAvail().x;
-            float totalWidth = std::max(plotWidth, (maxDataLength * plotWidth) / VISIBLE_POINTS);
+            float totalWidth = std::max(plotWidth, static_cast<float>(window.span / window.width) * plotWidth);
 
             ImGui::BeginChild(("ScrollingRegion##" + model.name).c_str(),
                               ImVec2(0, 200), true,
@@ -1201,60 +1728,59 @@ void renderModelPlots()
                 ImGui::SetScrollX(globalScrollX);
             }
 
-            if (simulationRunning && maxDataLength > VISIBLE_POINTS)
+            if (simulationRunning && window.span > window.width)
             {
                 float maxScroll = ImGui::GetScrollMaxX();
                 handleGlobalScroll(maxScroll, true);
             }
 
             ImPlotFlags plot_flags = flags | ImPlotFlags_NoLegend;
-            if (showLegends[&model - &availableModels[0]])
+            if (showLegends[modelIndex])
             {
                 plot_flags &= ~ImPlotFlags_NoLegend;
             }
 
             if (ImPlot::BeginPlot(plotLabel.c_str(), ImVec2(totalWidth, -1), plot_flags))
             {
-                ImPlot::SetupAxes("Data Point", "Attack Detection", axes_flags, axes_flags);
+                ImPlot::SetupAxes("Time (s)", "Attack Detection", axes_flags, axes_flags);
 
                 float scrollX = ImGui::GetScrollX();
-                int startPoint = static_cast<int>((scrollX / totalWidth) * maxDataLength);
-                int endPoint = startPoint + VISIBLE_POINTS;
+                double startTime = (scrollX / totalWidth) * window.span;
+                double endTime = startTime + window.width;
 
-                ImPlot::SetupAxisLimits(ImAxis_X1, startPoint, endPoint, ImGuiCond_Always);
+                ImPlot::SetupAxisLimits(ImAxis_X1, startTime, endTime, ImGuiCond_Always);
                 ImPlot::SetupAxisLimits(ImAxis_Y1, -0.2, 1.2, ImGuiCond_Always);
 
-                for (const auto &[connection, values] : model.plotData[0].values)
+                for (size_t id = 0; id < predictions.connectionCount(); ++id)
                 {
+                    SeriesColumn values = predictions.column(id, 0);
                     if (!values.empty())
                     {
-                        std::string label = "FB" + std::to_string(connection.first) +
-                                            " -> TB" + std::to_string(connection.second);
+                        const std::string &label = snapshot.connectionLabels[id];
 
-                        size_t endIdx = std::min<size_t>(endPoint, values.size());
-                        size_t startIdx = std::min<size_t>(startPoint, values.size());
+                        auto [startIdx, endIdx] = visibleRows(values, window.origin, startTime, endTime);
 
                         if (startIdx < endIdx)
                         {
-                            for (size_t j = startIdx; j < endIdx; ++j)
-                            {
-                                double x = static_cast<double>(j);
-                                double y = values[j] >= 0.5 ? 1.0 : 0.0;
-
-                                // Determine point color based on prediction value
-                                ImVec4 pointColor;
-                                if (values[j] >= 0.9) // MITM
-                                    pointColor = ATTACK_COLORS[3];
-                                else if (values[j] >= 0.7) // SYN Flood
-                                    pointColor = ATTACK_COLORS[2];
-                                else if (values[j] >= 0.5) // DDoS
-                                    pointColor = ATTACK_COLORS[1];
-                                else // Normal
-                                    pointColor = ATTACK_COLORS[0];
-
-                                ImPlot::SetNextMarkerStyle(ImPlotMarker_Square, 4, pointColor);
-                                ImPlot::PlotScatter(label.c_str(), &x, &y, 1);
-                            }
+                            forEachVisibleMarker(values, startIdx, endIdx, static_cast<int>(plotWidth), window.origin,
+                                                 [&](double x, float value)
+                                                 {
+                                                     double y = value >= 0.5 ? 1.0 : 0.0;
+
+                                                     // Determine point color based on prediction value
+                                                     ImVec4 pointColor;
+                                                     if (value >= 0.9) // MITM
+                                                         pointColor = ATTACK_COLORS[3];
+                                                     else if (value >= 0.7) // SYN Flood
+                                                         pointColor = ATTACK_COLORS[2];
+                                                     else if (value >= 0.5) // DDoS
+                                                         pointColor = ATTACK_COLORS[1];
+                                                     else // Normal
+                                                         pointColor = ATTACK_COLORS[0];
+
+                                                     ImPlot::SetNextMarkerStyle(ImPlotMarker_Square, 4, pointColor);
+                                                     ImPlot::PlotScatter(label.c_str(), &x, &y, 1);
+                                                 });
                         }
                     }
                 }
@@ -1264,7 +1790,7 @@ void renderModelPlots()
             ImGui::EndChild(); // End scrolling region
 
             // Show accuracy information only when legend is enabled
-            if (showLegends[&model - &availableModels[0]])
+            if (showLegends[modelIndex])
             {
                 ImGui::Text("Detection Accuracy by Attack Type:");
                 ImGui::Indent();
@@ -1296,6 +1822,100 @@ void renderModelPlots()
     }
 }
 
+// Parses one newline-framed JSON record. The flat numeric array
+// send_to_cpp() emits is parsed straight into the Record; nlohmann only
+// sees input that path rejects. Records with fewer than RECORD_FIELD_COUNT
+// values are rejected.
+bool decodeRecord(const char *line, size_t len, Record &record)
+{
+    if (parseJsonRecord(line, line + len, record))
+    {
+        return true;
+    }
+
+    try
+    {
+        json j = json::parse(line, line + len);
+        size_t count = 0;
+        for (const auto &[key, value] : j.items())
+        {
+            if (count == RECORD_FIELD_COUNT)
+            {
+                break;
+            }
+            record.setField(count++, value.is_number() ? value.get<double>() : 0.0);
+        }
+        return count == RECORD_FIELD_COUNT;
+    }
+    catch (const json::parse_error &e)
+    {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Reassembles one received chunk, in whichever wire format the connection
+// speaks, and hands the complete records in it to processData() through the
+// lock-free dataQueue, a batch at a time.
+void enqueueReceivedData(RecordStream &stream, const char *data, size_t len)
+{
+    const size_t BATCH_SIZE = 64;
+    Record batch[BATCH_SIZE];
+    size_t batchCount = 0;
+    auto flush = [&]()
+    {
+        dataQueue.push(batch, batchCount);
+        batchCount = 0;
+    };
+
+    uint64_t errorsBefore = stream.framingErrors();
+    stream.feed(
+        data, len,
+        [&](const char *line, size_t lineLen)
+        {
+            if (!decodeRecord(line, lineLen, batch[batchCount]))
+            {
+                return false;
+            }
+            if (++batchCount == BATCH_SIZE)
+            {
+                flush();
+            }
+            return true;
+        },
+        [&](const BinaryRecordView &record)
+        {
+            record.decode(batch[batchCount]);
+            if (++batchCount == BATCH_SIZE)
+            {
+                flush();
+            }
+        });
+    framingErrorCount += stream.framingErrors() - errorsBefore;
+    flush();
+}
+
+#ifdef SG_INGEST_EPOLL
+void receiveDataFromPython()
+{
+    if (!ingestServer.open(12345))
+    {
+        return;
+    }
+
+    std::unordered_map<int, RecordStream> streams;
+    ingestServer.run([&streams](int fd, const char *data, size_t len)
+                     {
+        if (receiverRunning)
+        {
+            enqueueReceivedData(streams[fd], data, len);
+        } },
+                     [&streams](int fd)
+                     { streams.erase(fd); });
+
+    std::cout << "Receiver stopped, framing errors: " << framingErrorCount << std::endl;
+}
+#else
 void receiveDataFromPython()
 {
     WSADATA wsaData;
@@ -1343,6 +1963,7 @@ void receiveDataFromPython()
     }
 
     std::vector<SOCKET> clientSockets;
+    std::unordered_map<SOCKET, RecordStream> streams;
 
     while (!shouldExit)
     {
@@ -1381,41 +2002,19 @@ void receiveDataFromPython()
                 {
                     if (FD_ISSET(*it, &readSet))
                     {
-                        char recvbuf[1024];
-                        int iResult = recv(*it, recvbuf, 1024, 0);
+                        char recvbuf[16384];
+                        int iResult = recv(*it, recvbuf, sizeof(recvbuf), 0);
 
                         if (iResult > 0)
                         {
-                            // Process received data
-                            std::string receivedData(recvbuf, iResult);
-                            try
-                            {
-                                json j = json::parse(receivedData);
-                                std::vector<float> dataPoint;
-                                for (const auto &[key, value] : j.items())
-                                {
-                                    if (value.is_number())
-                                    {
-                                        dataPoint.push_back(value.get<float>());
-                                    }
-                                    else
-                                    {
-                                        dataPoint.push_back(0.0f);
-                                    }
-                                }
-                                std::lock_guard<std::mutex> lock(queueMutex);
-                                dataQueue.push(dataPoint);
-                            }
-                            catch (const json::parse_error &e)
-                            {
-                                std::cerr << "JSON parse error: " << e.what() << std::endl;
-                            }
+                            enqueueReceivedData(streams[*it], recvbuf, iResult);
                             ++it;
                         }
                         else
                         {
                             // Connection closed or error
                             closesocket(*it);
+                            streams.erase(*it);
                             it = clientSockets.erase(it);
                         }
                     }
@@ -1441,8 +2040,10 @@ void receiveDataFromPython()
         listenSocket = INVALID_SOCKET;
     }
 
+    std::cout << "Receiver stopped, framing errors: " << framingErrorCount << std::endl;
     WSACleanup();
 }
+#endif
 
 void saveModelAndStatistics(const ModelInfo &model, const json &stats)
 {
@@ -1483,35 +2084,40 @@ void saveModelAndStatistics(const ModelInfo &model, const json &stats)
     std::string modelFilename = model.name + ".pkl";
     std::filesystem::path modelPath = saveDir / modelFilename;
 
-    // Send a command to the Python script to save the model
-    json saveCommand;
-    saveCommand["command"] = "save_model";
-    saveCommand["path"] = modelPath.string();
-    std::string jsonStr = saveCommand.dump();
-    if (send(model.socket, jsonStr.c_str(), jsonStr.length(), 0) == SOCKET_ERROR)
+    if (model.detector)
     {
-        std::cerr << "Failed to send save command to Python script" << std::endl;
-        return;
-    }
-
-    // Wait for response from Python script
-    char recvbuf[1024];
-    int iResult = recv(model.socket, recvbuf, 1024, 0);
-    if (iResult > 0)
-    {
-        std::string response(recvbuf, iResult);
-        json responseJson = json::parse(response);
-        if (responseJson["status"] != "success")
+        // No prediction script holds this model; its .pkl is unchanged on disk.
+        std::error_code error;
+        std::filesystem::copy_file(modelFilePath(model, getExecutableDir()), modelPath,
+                                   std::filesystem::copy_options::overwrite_existing, error);
+        if (error)
         {
-            std::cerr << "Failed to save model: " << responseJson["message"] << std::endl;
+            std::cerr << "Failed to save model: " << error.message() << std::endl;
             return;
         }
         std::cout << "Model saved successfully to " << modelPath << std::endl;
     }
     else
     {
-        std::cerr << "Failed to receive response from Python script" << std::endl;
-        return;
+        // Send a command to the Python script to save the model
+        json saveCommand;
+        saveCommand["command"] = "save_model";
+        saveCommand["path"] = modelPath.string();
+        std::string reply;
+        auto ignorePrediction = [](const PredictionClient::Completion &) {};
+        if (!model.client ||
+            !model.client->command(saveCommand.dump(), reply, ignorePrediction, std::chrono::seconds(10)))
+        {
+            std::cerr << "Failed to receive response from Python script" << std::endl;
+            return;
+        }
+        json responseJson = json::parse(reply, nullptr, false);
+        if (!responseJson.is_object() || responseJson.value("status", std::string()) != "success")
+        {
+            std::cerr << "Failed to save model: " << reply << std::endl;
+            return;
+        }
+        std::cout << "Model saved successfully to " << modelPath << std::endl;
     }
 
     // Copy network_traffic.csv to the timestamped folder
@@ -1611,9 +2217,7 @@ void startWiresharkCapture()
     std::cout << "Starting Wireshark capture..." << std::endl;
 
     // Get the path to the Python interpreter and script
-    char exePath[MAX_PATH];
-    GetModuleFileNameA(NULL, exePath, MAX_PATH);
-    std::filesystem::path executablePath = std::filesystem::path(exePath).parent_path();
+    std::filesystem::path executablePath = getExecutableDir();
     std::filesystem::path scriptPath = executablePath / "wireshark_capture.py";
 
     // Create the command string
@@ -1667,12 +2271,14 @@ int main(int, char **)
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 130");
 
+#ifdef _WIN32
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
     {
         std::cerr << "WSAStartup failed.\n";
         return 1;
     }
+#endif
 
     initPython();
     initAvailableModels();
@@ -1684,15 +2290,33 @@ int main(int, char **)
     receiverRunning = true;
     wiresharkRunning = false;
 
+    std::error_code tempError;
+    std::filesystem::path tempDirectory = std::filesystem::temp_directory_path(tempError);
+    if (!tempError)
+    {
+        seriesSpillDirectory = tempDirectory / "sg_series";
+        metricSeries.enableSpill(seriesSpillDirectory);
+    }
+    else
+    {
+        std::cerr << "No temp directory for series spill files; keeping only the in-memory window" << std::endl;
+    }
+
     std::thread receiverThread(receiveDataFromPython);
+    std::thread pipelineThread(processingThread);
 
-    char exePath[MAX_PATH];
-    GetModuleFileNameA(NULL, exePath, MAX_PATH);
-    std::filesystem::path executablePath = std::filesystem::path(exePath).parent_path();
+    std::filesystem::path executablePath = getExecutableDir();
+    std::thread modelWatcherThread(nativeModelWatcherThread, executablePath);
+
+    // Frame build + draw time, excluding the vsync wait in glfwSwapBuffers,
+    // against the rate the processing thread is consuming records at.
+    FrameTimeWindow frameTimes;
+    RateMeter processedRate;
 
     while (!shouldExit && !glfwWindowShouldClose(window))
     {
         glfwPollEvents();
+        auto frameStart = std::chrono::steady_clock::now();
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -1744,8 +2368,44 @@ int main(int, char **)
             for (auto &model : availableModels)
             {
                 ImGui::Checkbox(model.name.c_str(), &model.selected);
+                ImGui::SameLine();
+                ImGui::Checkbox(("Native##" + model.name).c_str(), &model.native);
+                if (!model.native)
+                {
+                    // Applied to a running connection at its next batch.
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(100);
+                    if (ImGui::InputInt(("In flight##" + model.name).c_str(), &model.inFlightWindow))
+                    {
+                        model.inFlightWindow = std::clamp(model.inFlightWindow, 1, MAX_IN_FLIGHT_WINDOW);
+                    }
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(100);
+                    if (ImGui::InputInt(("Timeout ms##" + model.name).c_str(), &model.predictionTimeoutMs, 50, 500))
+                    {
+                        model.predictionTimeoutMs = std::clamp(model.predictionTimeoutMs, MIN_PREDICTION_TIMEOUT_MS,
+                                                               MAX_PREDICTION_TIMEOUT_MS);
+                    }
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(100);
+                    if (ImGui::InputInt(("Batch##" + model.name).c_str(), &model.predictionBatch))
+                    {
+                        model.predictionBatch = std::clamp(model.predictionBatch, 1, MAX_PREDICTION_BATCH);
+                    }
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(100);
+                    if (ImGui::InputInt(("Batch delay ms##" + model.name).c_str(), &model.batchDelayMs))
+                    {
+                        model.batchDelayMs = std::clamp(model.batchDelayMs, 0, MAX_BATCH_DELAY_MS);
+                    }
+                }
             }
         }
+        double threshold = anomalyThreshold.load();
+        if (ImGui::InputDouble("Native isolation forest threshold", &threshold, 0.01, 0.05, "%.3f"))
+        {
+            anomalyThreshold = std::clamp(threshold, -1.0, 0.0);
+        }
 
         if (currentDataSource == DataSource::SIMULATION)
         {
@@ -1803,10 +2463,11 @@ int main(int, char **)
                         }
                         pythonScriptThreads.clear();
 
-                        // Start prediction scripts
+                        // Load in-process models, then start prediction scripts for the rest
+                        prepareNativeModels(executablePath);
                         for (auto &model : availableModels)
                         {
-                            if (model.selected)
+                            if (model.selected && !model.detector)
                             {
                                 pythonScriptThreads.emplace_back([&model, &executablePath]()
                                                                  {
@@ -1827,36 +2488,9 @@ int main(int, char **)
                             }
                         }
 
-                        // Wait longer for prediction scripts to start
-                        std::cout << "Waiting for prediction scripts to initialize..." << std::endl;
-                        std::this_thread::sleep_for(std::chrono::seconds(3));
-
-                        // Initialize sockets with retries
-                        int socketRetries = 0;
-                        const int MAX_SOCKET_RETRIES = 3;
-                        bool socketsInitialized = false;
-
-                        while (!socketsInitialized && socketRetries < MAX_SOCKET_RETRIES)
-                        {
-                            if (socketRetries > 0)
-                            {
-                                std::cout << "Retrying socket initialization, attempt "
-                                          << socketRetries + 1 << "..." << std::endl;
-                                std::this_thread::sleep_for(std::chrono::seconds(1));
-                            }
-
-                            if (initPredictionSocket())
-                            {
-                                socketsInitialized = true;
-                                std::cout << "All prediction sockets initialized successfully" << std::endl;
-                            }
-                            else
-                            {
-                                socketRetries++;
-                            }
-                        }
-
-                        if (!socketsInitialized)
+                        // Connects as soon as each prediction script is listening;
+                        // returns at once when every selected model runs in process.
+                        if (!initPredictionSocket())
                         {
                             std::cerr << "Failed to initialize prediction sockets. Stopping simulation." << std::endl;
                             simulationRunning = false;
@@ -1866,6 +2500,7 @@ int main(int, char **)
                         }
                         else
                         {
+                            std::cout << "All prediction sockets initialized successfully" << std::endl;
                             // Start simulation thread
                             std::thread(simulationThread).detach();
                         }
@@ -1883,12 +2518,7 @@ int main(int, char **)
                     simulationRunning = true;
 
                     // Clear existing data
-                    dataQueue = std::queue<std::vector<float>>();
-                    for (auto &plotData : plotDataArray)
-                    {
-                        plotData.values.clear();
-                    }
-                    fbTbCombinations.clear();
+                    resetSeries();
 
                     // Initialize prediction scripts for models
                     std::lock_guard<std::mutex> lock(modelsMutex);
@@ -1901,9 +2531,10 @@ int main(int, char **)
                     }
                     pythonScriptThreads.clear();
 
+                    prepareNativeModels(executablePath);
                     for (auto &model : availableModels)
                     {
-                        if (model.selected)
+                        if (model.selected && !model.detector)
                         {
                             pythonScriptThreads.emplace_back([&model, &executablePath]()
                                                              {
@@ -1920,10 +2551,7 @@ int main(int, char **)
                         }
                     }
 
-                    // Wait for prediction scripts to start
-                    std::this_thread::sleep_for(std::chrono::seconds(2));
-
-                    // Initialize model sockets
+                    // Initialize model sockets once the scripts are listening
                     if (!initPredictionSocket())
                     {
                         std::cerr << "Failed to initialize prediction sockets" << std::endl;
@@ -2078,6 +2706,34 @@ int main(int, char **)
         // Plot Controls and Rendering
         ImGui::Spacing();
         ImGui::Separator();
+        ImGui::Text("Ingest queue: %zu / %zu (peak %zu), dropped: %llu, framing errors: %llu",
+                    dataQueue.size(), dataQueue.capacity(), dataQueue.highWaterMark(),
+                    static_cast<unsigned long long>(dataQueue.dropped()),
+                    static_cast<unsigned long long>(framingErrorCount.load()));
+        if (processedRate.update(recordsProcessed.load(std::memory_order_relaxed)) && simulationRunning)
+        {
+            std::cout << "Pipeline: " << processedRate.rate() << " records/s, frame avg "
+                      << frameTimes.average() << " ms, p99 " << frameTimes.percentile(0.99f)
+                      << " ms, worst " << frameTimes.worst() << " ms" << std::endl;
+        }
+        ImGui::Text("Processed: %.0f records/s | frame time: %.2f ms avg, %.2f ms p99, %.2f ms worst",
+                    processedRate.rate(), frameTimes.average(), frameTimes.percentile(0.99f), frameTimes.worst());
+        float retentionSeconds = seriesRetentionSeconds.load();
+        if (ImGui::InputFloat("Seconds kept in memory per series", &retentionSeconds, 10.0f, 60.0f, "%.0f"))
+        {
+            seriesRetentionSeconds = std::clamp(retentionSeconds, 0.0f, 86400.0f);
+        }
+        int retention = seriesRetention.load();
+        if (ImGui::InputInt("Max points in memory per series", &retention, 100, 1000))
+        {
+            seriesRetention = std::clamp(retention, 100, 1000000);
+        }
+        if (ImGui::InputFloat("Visible seconds", &visibleSeconds, 1.0f, 10.0f, "%.1f"))
+        {
+            visibleSeconds = std::clamp(visibleSeconds, 0.1f, 86400.0f);
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Whole capture", &showWholeCapture);
         ImGui::Text("Metrics Display:");
         ImGui::Columns(2, "MetricsColumns");
         for (size_t i = 0; i < metricLabels.size(); ++i)
@@ -2092,13 +2748,9 @@ int main(int, char **)
         }
         ImGui::Columns(1);
 
-        if (simulationRunning)
-        {
-            processData();
-        }
-
-        renderPlots();
-        renderModelPlots();
+        const PlotSnapshot &snapshot = plotSnapshots.read();
+        renderPlots(snapshot);
+        renderModelPlots(snapshot);
 
         ImGui::End();
 
@@ -2109,6 +2761,7 @@ int main(int, char **)
         glViewport(0, 0, display_w, display_h);
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        frameTimes.add(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
         glfwSwapBuffers(window);
     }
 
@@ -2175,6 +2828,9 @@ int main(int, char **)
     }
 
     std::cout << "Closing listen socket..." << std::endl;
+#ifdef SG_INGEST_EPOLL
+    ingestServer.stop();
+#endif
     if (listenSocket != INVALID_SOCKET)
     {
         shutdown(listenSocket, SD_BOTH);
@@ -2182,6 +2838,16 @@ int main(int, char **)
         listenSocket = INVALID_SOCKET;
     }
 
+    std::cout << "Waiting for processing thread..." << std::endl;
+    if (pipelineThread.joinable())
+    {
+        pipelineThread.join();
+    }
+    if (modelWatcherThread.joinable())
+    {
+        modelWatcherThread.join();
+    }
+
     std::cout << "Waiting for receiver thread..." << std::endl;
     if (receiverThread.joinable())
     {
@@ -2200,7 +2866,9 @@ int main(int, char **)
     }
 
     std::cout << "Performing final cleanup..." << std::endl;
+#ifdef _WIN32
     WSACleanup();
+#endif
     Py_Finalize();
 
     ImGui_ImplOpenGL3_Shutdown();
@@ -142,7 +142,9 @@ class ModelStats:
         }
 
 
-def predict(model_dict, data):
+def predict_batch(model_dict, rows):
+    """Scores a list of feature rows with one call into the model. Returns
+    the attack type for every row and the time the whole batch took."""
     start_time = time.perf_counter()
     try:
         # Check if model is stored in a dictionary with preprocessors
@@ -153,7 +155,7 @@ def predict(model_dict, data):
             imputer = model_dict.get("imputer")
 
             # Preprocess data if necessary
-            processed_data = [data]
+            processed_data = rows
             if imputer is not None:
                 processed_data = imputer.transform(processed_data)
             if scaler is not None:
@@ -161,23 +163,24 @@ def predict(model_dict, data):
 
             # Handle different model types
             if hasattr(model, "cluster_centers_"):  # KMeans
-                cluster = model.predict(processed_data)[0]
-                # Convert 'normal' to 'none' in prediction
-                prediction = model_dict["cluster_mappings"].get(cluster, "none")
-                result = "none" if prediction.lower() in ["normal", "none"] else prediction.lower()
+                clusters = model.predict(processed_data)
+                predictions = [model_dict["cluster_mappings"].get(cluster, "none") for cluster in clusters]
 
             elif hasattr(model, "score_samples"):  # Isolation Forest
-                score = model.score_samples(processed_data)[0]
                 threshold = -0.5
-                result = "ddos" if score < threshold else "none"
+                predictions = ["ddos" if score < threshold else "none" for score in model.score_samples(processed_data)]
 
             else:  # Random Forest or other classifiers
-                prediction = str(model.predict(processed_data)[0]).lower()
-                result = "none" if prediction in ["normal", "none"] else prediction
+                predictions = model.predict(processed_data)
 
         else:  # Model without preprocessors (like decision tree)
-            prediction = str(model_dict.predict([data])[0]).lower()
-            result = "none" if prediction in ["normal", "none"] else prediction
+            predictions = model_dict.predict(rows)
+
+        # Convert 'normal' to 'none' in prediction
+        results = []
+        for prediction in predictions:
+            prediction = str(prediction).lower()
+            results.append("none" if prediction in ["normal", "none"] else prediction)
 
     except Exception as e:
         logger.error(f"Error making prediction: {e}", exc_info=True)
@@ -186,86 +189,106 @@ def predict(model_dict, data):
             logger.error(f"Model keys: {model_dict.keys()}")
             if "cluster_mappings" in model_dict:
                 logger.error(f"Cluster mappings: {model_dict['cluster_mappings']}")
-        result = "none"  # Default to no attack if prediction fails
+        results = ["none"] * len(rows)  # Default to no attack if prediction fails
 
     end_time = time.perf_counter()
-    return result, end_time - start_time
+    return results, end_time - start_time
+
+
+def predict(model_dict, data):
+    results, prediction_time = predict_batch(model_dict, [data])
+    return results[0], prediction_time
+
+
+def record_features(json_data):
+    return [
+        json_data["IAT"],
+        json_data["TD"],
+        json_data["Arrival Time"],
+        json_data["PC"],
+        json_data["Packet Size"],
+        json_data["Acknowledgement Packet Size"],
+        json_data["RTT"],
+        json_data["Average Queue Size"],
+        json_data["System Occupancy"],
+        json_data["Arrival Rate"],
+        json_data["Service Rate"],
+        json_data["Packet Dropped"],
+    ]
+
+
+def record_attack_flags(json_data):
+    return {
+        "attack_none": json_data.get("attack_none", 0),
+        "attack_ddos": json_data.get("attack_ddos", 0),
+        "attack_synflood": json_data.get("attack_synflood", 0),
+        "attack_mitm": json_data.get("attack_mitm", 0),
+    }
+
+
+def send_message(conn, message):
+    conn.sendall((json.dumps(message) + "\n").encode())
+
 
 def handle_connection(conn, addr, model_name, model, stats):
     logger.info(f"Handling connection for {model_name} from {addr}")
 
     try:
-        while True:
-            data = conn.recv(1024)
-            if not data:
-                break
-
-            json_data = json.loads(data.decode())
-
-            if json_data.get("command") == "get_stats":
-                stats_data = stats.get_stats()
-                stats_data["model_name"] = model_name
-                conn.sendall(json.dumps(stats_data).encode())
-                logger.info(f"Sent statistics for {model_name}")
-
-            elif json_data.get("command") == "save_model":
-                try:
-                    joblib.dump(model, json_data["path"])
-                    logger.info(f"Model saved successfully to {json_data['path']}")
-                    conn.sendall(
-                        json.dumps(
-                            {"status": "success", "message": "Model saved successfully"}
-                        ).encode()
-                    )
-                except Exception as e:
-                    error_message = f"Failed to save model: {str(e)}"
-                    logger.error(error_message)
-                    conn.sendall(
-                        json.dumps(
-                            {"status": "error", "message": error_message}
-                        ).encode()
-                    )
-
-            else:
-                features = [
-                    json_data["IAT"],
-                    json_data["TD"],
-                    json_data["Arrival Time"],
-                    json_data["PC"],
-                    json_data["Packet Size"],
-                    json_data["Acknowledgement Packet Size"],
-                    json_data["RTT"],
-                    json_data["Average Queue Size"],
-                    json_data["System Occupancy"],
-                    json_data["Arrival Rate"],
-                    json_data["Service Rate"],
-                    json_data["Packet Dropped"],
-                ]
-
-                attack_flags = {
-                    "attack_none": json_data.get("attack_none", 0),
-                    "attack_ddos": json_data.get("attack_ddos", 0),
-                    "attack_synflood": json_data.get("attack_synflood", 0),
-                    "attack_mitm": json_data.get("attack_mitm", 0),
-                }
-
-                prediction, pred_time = predict(model, features)
-                logger.info(f"Raw prediction: {prediction}")
-
-                # Ensure prediction is 'none' instead of 'normal'
-                if prediction.lower() in ["normal", "none"]:
-                    prediction = "none"
-
-                # Send prediction back to C++
-                response = {
-                    "prediction": 1.0 if prediction != "none" else 0.0,
-                    "attack_type": prediction,
-                }
-                logger.info(f"Final prediction: {prediction}")
-                conn.sendall(json.dumps(response).encode())
-
-                # Update statistics with standardized prediction and timing
-                stats.update(prediction, attack_flags, pred_time)
+        # One JSON object per line. The C++ client keeps several prediction
+        # requests in flight, so one read can hold many of them; each answer
+        # echoes its request's "id" so the client can route it. A request is
+        # either one record or {"id": ..., "records": [...]}.
+        with conn.makefile("rb") as lines:
+            for line in lines:
+                if not line.strip():
+                    continue
+                json_data = json.loads(line)
+
+                if json_data.get("command") == "get_stats":
+                    stats_data = stats.get_stats()
+                    stats_data["model_name"] = model_name
+                    send_message(conn, stats_data)
+                    logger.info(f"Sent statistics for {model_name}")
+
+                elif json_data.get("command") == "save_model":
+                    try:
+                        joblib.dump(model, json_data["path"])
+                        logger.info(f"Model saved successfully to {json_data['path']}")
+                        send_message(conn, {"status": "success", "message": "Model saved successfully"})
+                    except Exception as e:
+                        error_message = f"Failed to save model: {str(e)}"
+                        logger.error(error_message)
+                        send_message(conn, {"status": "error", "message": error_message})
+
+                elif "records" in json_data:
+                    # A batch: every record is scored in one model call and
+                    # answered in one message, predictions in record order.
+                    records = json_data["records"]
+                    predictions, pred_time = predict_batch(model, [record_features(record) for record in records])
+                    logger.info(f"Scored a batch of {len(records)} records")
+                    send_message(conn, {
+                        "id": json_data.get("id"),
+                        "predictions": [1.0 if prediction != "none" else 0.0 for prediction in predictions],
+                        "attack_types": predictions,
+                    })
+                    for record, prediction in zip(records, predictions):
+                        stats.update(prediction, record_attack_flags(record), pred_time / len(records))
+
+                else:
+                    prediction, pred_time = predict(model, record_features(json_data))
+                    logger.info(f"Final prediction: {prediction}")
+
+                    # Send prediction back to C++
+                    response = {
+                        "prediction": 1.0 if prediction != "none" else 0.0,
+                        "attack_type": prediction,
+                    }
+                    if "id" in json_data:
+                        response["id"] = json_data["id"]
+                    send_message(conn, response)
+
+                    # Update statistics with standardized prediction and timing
+                    stats.update(prediction, record_attack_flags(json_data), pred_time)
 
     except Exception as e:
         logger.error(f"Error processing data for {model_name}: {e}")
@@ -12,6 +12,7 @@ import csv
 import queue
 import simpy
 from SimComponents import PacketGenerator, PacketSink, SwitchPort, PortMonitor
+from wire_format import encode_record
 
 print("simulation_script.py: Starting execution")
 
@@ -104,9 +105,7 @@ def send_to_cpp(data):
                 data["attack_synflood"],
                 data["attack_mitm"],
             ]
-            json_str = json.dumps(ordered_data) + "\n"
-            sock.send(json_str.encode())
-            # sock.sendall(json.dumps(ordered_data).encode())
+            sock.sendall(encode_record(ordered_data))
         except Exception as e:
             print(f"Error sending data to C++: {e}")
 
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "record_stream.h"
+
+static int failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(bool ok, const char *expression, int line)
+{
+    if (!ok)
+    {
+        std::fprintf(stderr, "test_record_stream.cpp:%d: CHECK failed: %s\n", line, expression);
+        ++failures;
+    }
+}
+
+struct Decoded
+{
+    std::vector<double> firstFields; // field 0 of every record, in order
+    uint64_t framingErrors = 0;
+};
+
+static void appendFrame(std::vector<char> &stream, double id, FieldEncoding encoding)
+{
+    double values[RECORD_FIELD_COUNT];
+    for (size_t f = 0; f < RECORD_FIELD_COUNT; ++f)
+        values[f] = id + static_cast<double>(f);
+    char frame[MAX_BINARY_RECORD_SIZE];
+    size_t size = encodeBinaryRecord(values, encoding, frame);
+    stream.insert(stream.end(), frame, frame + size);
+}
+
+// Feeds stream in reads of the given sizes; the last read takes the rest.
+static Decoded decode(const std::vector<char> &stream, const std::vector<size_t> &reads)
+{
+    RecordStream records;
+    Decoded decoded;
+    auto onJsonLine = [](const char *, size_t) { return true; };
+    auto onBinary = [&decoded](const BinaryRecordView &record) { decoded.firstFields.push_back(record.field(0)); };
+    size_t position = 0;
+    for (size_t read : reads)
+    {
+        size_t n = std::min(read, stream.size() - position);
+        records.feed(stream.data() + position, n, onJsonLine, onBinary);
+        position += n;
+    }
+    records.feed(stream.data() + position, stream.size() - position, onJsonLine, onBinary);
+    CHECK(records.format() == RecordStream::Format::BINARY);
+    decoded.framingErrors = records.framingErrors();
+    return decoded;
+}
+
+// Valid frames with stray magic bytes and truncated headers between them,
+// decoded whole and in random reads: every frame comes out, in order, with
+// the same framing error count however the stream is split.
+static void corruptStreamsDecodeAlikeWholeAndChunked()
+{
+    for (unsigned seed = 0; seed < 3000; ++seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<char> stream;
+        std::vector<double> expected;
+        int frames = 5 + static_cast<int>(random() % 20);
+        for (int f = 0; f < frames; ++f)
+        {
+            switch (random() % 4)
+            {
+            case 0:
+                stream.push_back(static_cast<char>(BINARY_RECORD_MAGIC0));
+                break;
+            case 1:
+                stream.push_back(static_cast<char>(BINARY_RECORD_MAGIC0));
+                stream.push_back(static_cast<char>(BINARY_RECORD_MAGIC1));
+                break;
+            default:
+                break;
+            }
+            double id = f * 100.0;
+            appendFrame(stream, id, random() % 2 ? FieldEncoding::FLOAT64 : FieldEncoding::FLOAT32);
+            expected.push_back(id);
+        }
+
+        Decoded whole = decode(stream, {});
+        std::vector<size_t> reads;
+        for (size_t total = 0; total < stream.size();)
+        {
+            reads.push_back(1 + random() % 40);
+            total += reads.back();
+        }
+        Decoded chunked = decode(stream, reads);
+
+        CHECK(whole.firstFields == expected);
+        CHECK(chunked.firstFields == expected);
+        CHECK(chunked.framingErrors == whole.framingErrors);
+        if (failures > 0)
+        {
+            std::fprintf(stderr, "  seed %u\n", seed);
+            return;
+        }
+    }
+}
+
+// A stray magic byte at the end of one read is staged; the next read
+// completes its header with the start of a valid frame, which fails
+// validation. The frame must still be decoded from the staged bytes.
+static void invalidStagedHeaderKeepsFollowingFrame()
+{
+    std::vector<char> stream;
+    stream.push_back(static_cast<char>(BINARY_RECORD_MAGIC0));
+    appendFrame(stream, 1.0, FieldEncoding::FLOAT32);
+    appendFrame(stream, 2.0, FieldEncoding::FLOAT64);
+
+    Decoded split = decode(stream, {1});
+    CHECK((split.firstFields == std::vector<double>{1.0, 2.0}));
+    CHECK(split.framingErrors == 1);
+
+    // Bad version, with the header split three ways.
+    std::vector<char> badVersion = {static_cast<char>(BINARY_RECORD_MAGIC0), static_cast<char>(BINARY_RECORD_MAGIC1),
+                                    static_cast<char>(BINARY_RECORD_VERSION + 1)};
+    appendFrame(badVersion, 3.0, FieldEncoding::FLOAT32);
+    Decoded staged = decode(badVersion, {2, 4});
+    CHECK((staged.firstFields == std::vector<double>{3.0}));
+    CHECK(staged.framingErrors == decode(badVersion, {}).framingErrors);
+}
+
+// A frame split byte by byte is staged across every read.
+static void frameSplitIntoSingleBytes()
+{
+    std::vector<char> stream;
+    appendFrame(stream, 7.0, FieldEncoding::FLOAT64);
+    appendFrame(stream, 8.0, FieldEncoding::FLOAT32);
+    Decoded decoded = decode(stream, std::vector<size_t>(stream.size(), 1));
+    CHECK((decoded.firstFields == std::vector<double>{7.0, 8.0}));
+    CHECK(decoded.framingErrors == 0);
+}
+
+int main()
+{
+    invalidStagedHeaderKeepsFollowingFrame();
+    frameSplitIntoSingleBytes();
+    corruptStreamsDecodeAlikeWholeAndChunked();
+    if (failures == 0)
+        std::puts("test_record_stream: all checks passed");
+    return failures == 0 ? 0 : 1;
+}
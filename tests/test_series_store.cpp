@@ -0,0 +1,154 @@
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include "series_store.h"
+
+static int failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(bool ok, const char *expression, int line)
+{
+    if (!ok)
+    {
+        std::fprintf(stderr, "test_series_store.cpp:%d: CHECK failed: %s\n", line, expression);
+        ++failures;
+    }
+}
+
+static bool same(float a, float b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+// Every column of copy reads exactly like the same column of source: rows,
+// times, and min/max over random ranges.
+static void checkSame(const SeriesStore &copy, const SeriesStore &source, std::mt19937 &random)
+{
+    CHECK(copy.connectionCount() == source.connectionCount());
+    CHECK(copy.columnCount() == source.columnCount());
+    CHECK(copy.longestSeries() == source.longestSeries());
+    if (failures > 0)
+        return;
+    for (size_t id = 0; id < source.connectionCount(); ++id)
+    {
+        for (size_t c = 0; c < source.columnCount(); ++c)
+        {
+            SeriesColumn expected = source.column(id, c);
+            SeriesColumn actual = copy.column(id, c);
+            CHECK(actual.size() == expected.size());
+            CHECK(actual.origin == expected.origin);
+            if (failures > 0)
+                return;
+            size_t size = expected.size();
+            for (size_t i = 0; i < size; ++i)
+            {
+                if (!same(actual[i], expected[i]) || actual.time(i) != expected.time(i))
+                {
+                    std::fprintf(stderr, "  connection %zu column %zu row %zu of %zu differs\n", id, c, i, size);
+                    CHECK(same(actual[i], expected[i]));
+                    CHECK(actual.time(i) == expected.time(i));
+                    return;
+                }
+            }
+            for (int q = 0; q < 20 && size > 0; ++q)
+            {
+                size_t first = random() % size;
+                size_t last = first + random() % (size - first + 1);
+                float expectedMin, expectedMax, actualMin, actualMax;
+                bool expectedAny = expected.range(first, last, expectedMin, expectedMax);
+                bool actualAny = actual.range(first, last, actualMin, actualMax);
+                CHECK(actualAny == expectedAny);
+                if (expectedAny && actualAny)
+                {
+                    CHECK(actualMin == expectedMin);
+                    CHECK(actualMax == expectedMax);
+                }
+                if (failures > 0)
+                    return;
+            }
+        }
+    }
+}
+
+// Mirrors how the renderer uses the store: three snapshots synced in turn
+// from one live store, each a couple of syncs behind, while the live store
+// grows, laps its rings, changes retention, clears and spills. A sync that
+// skips or half-copies a changed connection shows up as a mismatch.
+static void rotatingSnapshotsMatchSource(const std::filesystem::path &scratch)
+{
+    std::filesystem::path blocked = scratch / "not-a-directory";
+    std::ofstream(blocked).put('x');
+
+    for (unsigned seed = 0; seed < 16; ++seed)
+    {
+        std::mt19937 random(seed);
+        size_t columns = 1 + random() % 4;
+        SeriesStore source(columns, 16 + random() % 3000, random() % 3 ? 0.0 : 5.0);
+        // Odd seeds spill; every fourth of those to a path that cannot be
+        // created, so the store gives up spilling partway through.
+        if (seed % 4 == 3)
+            source.enableSpill(blocked / "spill");
+        else if (seed % 2 == 1)
+            source.enableSpill(scratch / ("spill-" + std::to_string(seed)));
+        SeriesStore snapshots[3];
+        size_t connections = 1 + random() % 20;
+        double t = 0.0;
+        for (int step = 0; step < 120; ++step)
+        {
+            // Rows go to the first few connections only, so the rest sit
+            // idle across syncs. Now and then a burst long enough to lap
+            // every ring, and once one into a single connection that seals
+            // spill chunks.
+            size_t busy = 1 + random() % connections;
+            int rows = static_cast<int>(random() % (step % 50 == 0 ? 5000 : 200));
+            if (step == 75)
+            {
+                busy = 1;
+                rows = static_cast<int>(3000 + 3 * SPILL_CHUNK_ROWS);
+            }
+            for (int r = 0; r < rows; ++r)
+            {
+                float row[4];
+                for (size_t c = 0; c < columns; ++c)
+                    row[c] = random() % 50 == 0 ? NAN : static_cast<float>(static_cast<int>(random() % 1000) - 500);
+                t += (random() % 10) * 0.01;
+                source.append(random() % busy, row, t);
+            }
+            if (random() % 40 == 0)
+                source.setRetention(16 + random() % 3000);
+            if (random() % 60 == 0)
+                source.setRetentionSeconds(random() % 2 ? 0.0 : 1.0 + random() % 10);
+            if (random() % 200 == 0)
+                source.clear();
+
+            SeriesStore &snapshot = snapshots[step % 3];
+            snapshot.syncFrom(source);
+            checkSame(snapshot, source, random);
+            if (seed % 4 == 3 && step >= 75)
+                CHECK(!source.spilling());
+            if (failures > 0)
+            {
+                std::fprintf(stderr, "  seed %u step %d\n", seed, step);
+                return;
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::random_device device;
+    std::filesystem::path scratch =
+        std::filesystem::temp_directory_path() / ("sg_test_series_store-" + std::to_string(device()));
+    std::filesystem::create_directories(scratch);
+    rotatingSnapshotsMatchSource(scratch);
+    std::error_code error;
+    std::filesystem::remove_all(scratch, error);
+    if (failures == 0)
+        std::puts("test_series_store: all checks passed");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <thread>
+#include "spsc_ring.h"
+
+static int failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(bool ok, const char *expression, int line)
+{
+    if (!ok)
+    {
+        std::fprintf(stderr, "test_spsc_ring.cpp:%d: CHECK failed: %s\n", line, expression);
+        ++failures;
+    }
+}
+
+// Balanced push/pop cycles never hold more than one burst, so the peak must
+// stay at the burst size however many times the ring wraps.
+static void highWaterAfterBalancedCycles()
+{
+    SpscRing<int> ring(1024);
+    int in[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    int out[8];
+    for (int cycle = 0; cycle < 1000; ++cycle)
+    {
+        CHECK(ring.push(in, 8) == 8);
+        CHECK(ring.pop(out, 8) == 8);
+    }
+    CHECK(ring.size() == 0);
+    CHECK(ring.highWaterMark() == 8);
+    CHECK(ring.dropped() == 0);
+}
+
+static void highWaterTracksPeak()
+{
+    SpscRing<int> ring(16);
+    int items[16] = {};
+    int out[16];
+    CHECK(ring.push(items, 5) == 5);
+    CHECK(ring.push(items, 3) == 3);
+    CHECK(ring.highWaterMark() == 8);
+    CHECK(ring.pop(out, 6) == 6);
+    CHECK(ring.push(items, 4) == 4);
+    CHECK(ring.highWaterMark() == 8);
+    CHECK(ring.push(items, 16) == 10);
+    CHECK(ring.highWaterMark() == 16);
+    CHECK(ring.dropped() == 6);
+}
+
+static void orderAcrossThreads()
+{
+    const int COUNT = 200000;
+    SpscRing<int> ring(256);
+    std::thread producer([&ring]()
+                         {
+                             for (int i = 0; i < COUNT;)
+                             {
+                                 if (ring.push(i))
+                                     ++i;
+                                 else
+                                     std::this_thread::yield();
+                             }
+                         });
+    int expected = 0;
+    int out[64];
+    while (expected < COUNT)
+    {
+        size_t n = ring.pop(out, 64);
+        if (n == 0)
+            std::this_thread::yield();
+        for (size_t i = 0; i < n; ++i)
+            CHECK(out[i] == expected++);
+    }
+    producer.join();
+    CHECK(ring.highWaterMark() <= ring.capacity());
+}
+
+int main()
+{
+    highWaterAfterBalancedCycles();
+    highWaterTracksPeak();
+    orderAcrossThreads();
+    if (failures == 0)
+        std::puts("test_spsc_ring: all checks passed");
+    return failures == 0 ? 0 : 1;
+}
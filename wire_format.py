@@ -0,0 +1,42 @@
+import json
+import os
+import struct
+
+# Binary record layout shared with include/binary_record.h:
+#   header: magic (0xA5, 'S'), version, field encoding, payload length (uint32)
+#   payload: 20 little-endian fields in send_to_cpp() column order; with the
+#            float32 encoding the timestamp at index 14 stays a float64.
+MAGIC = b"\xa5S"
+VERSION = 1
+ENCODING_FLOAT32 = 0
+ENCODING_FLOAT64 = 1
+FIELD_COUNT = 20
+TIMESTAMP_FIELD = 14
+
+_PAYLOAD_FORMATS = {
+    ENCODING_FLOAT32: "<14fd5f",
+    ENCODING_FLOAT64: "<20d",
+}
+_HEADER = struct.Struct("<2sBBI")
+_PAYLOAD = {enc: struct.Struct(fmt) for enc, fmt in _PAYLOAD_FORMATS.items()}
+
+
+def selected_format():
+    """Wire format chosen with SG_WIRE_FORMAT: "json" (default), "binary"
+    (float32 fields) or "binary64" (float64 fields)."""
+    return os.environ.get("SG_WIRE_FORMAT", "json").lower()
+
+
+def pack_binary(ordered_data, encoding=ENCODING_FLOAT32):
+    payload = _PAYLOAD[encoding].pack(*(float(v) for v in ordered_data))
+    return _HEADER.pack(MAGIC, VERSION, encoding, len(payload)) + payload
+
+
+def encode_record(ordered_data, wire_format=None):
+    """Encode one 20-field record for the C++ ingest server."""
+    wire_format = wire_format or selected_format()
+    if wire_format == "binary":
+        return pack_binary(ordered_data, ENCODING_FLOAT32)
+    if wire_format == "binary64":
+        return pack_binary(ordered_data, ENCODING_FLOAT64)
+    return (json.dumps(ordered_data) + "\n").encode()
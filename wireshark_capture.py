@@ -11,6 +11,7 @@ import pyshark
 import queue
 from concurrent.futures import ThreadPoolExecutor
 import csv
+from wire_format import encode_record
 
 print("wireshark_capture.py: Starting execution")
 
@@ -218,8 +219,7 @@ def send_to_cpp(data):
                 data["attack_synflood"], data["attack_mitm"]
             ]
             
-            json_str = json.dumps(ordered_data) + "\n"
-            sock.send(json_str.encode())
+            sock.sendall(encode_record(ordered_data))
             return True
         except Exception as e:
             logger.error(f"Error sending data to C++: {e}")